@@ -59,6 +59,11 @@ enum aet_marker_type_t
     ///
     /// `ED_SP`.
     AET_MARKER_TYPE_PRESS_END   = 0x8,
+
+    /// A change in tempo, where the beats per minute are the marker's value.
+    ///
+    /// `BPM` followed by the beats per minute, such as `BPM205`.
+    AET_MARKER_TYPE_BPM         = 0x9,
 };
 
 /// The different blend modes that a layer can use to blend it's source's colours with colours behind it.
@@ -290,6 +295,20 @@ struct aet_marker_t
     ///
     /// This is read by comparing the name of this marker against the known names of various types.
     enum aet_marker_type_t type;
+
+    /// The hash of this marker's name, excluding any trailing numeric value.
+    ///
+    /// This allows markers to be compared against names without any string operations,
+    /// see `aet_marker_name_hash(name, length)`.
+    uint32_t name_hash;
+
+    /// Whether or not this marker's name ends with a numeric value.
+    int has_value;
+
+    /// The numeric value at the end of this marker's name, such as `205` for `BPM205` or `3` for `X3`.
+    ///
+    /// If `has_value` is `0`, then this is `0`.
+    float value;
 };
 
 /// The data structure for a group of sprites within an AET.
@@ -339,9 +358,36 @@ void aet_open(const char *path, struct aet_t *aet);
 /// @param aet The AET to close.
 void aet_close(struct aet_t *aet);
 
+/// Get the hash of the given marker name, as used for `struct aet_marker_t` `name_hash`.
+///
+/// This is the 32-bit FNV-1a hash of the given characters.
+/// @param name The marker name to hash, excluding any trailing numeric value.
+/// @param length The number of characters within the given name to hash.
+/// @returns The hash of the given marker name.
+uint32_t aet_marker_name_hash(const char *name, size_t length);
+
 /// Get the given frame number in milliseconds.
 /// @param frame The frame number to convert.
 /// @param framerate The frame rate of the given frame number.
 /// @param speed The normalized playback speed of the given frame.
 /// @returns The millisecond of the given frame number accounting for the given properties.
 double aet_frame_to_ms(float frame, float framerate, float speed);
+
+/// Sample the value of the given keyframes at the given frame.
+///
+/// Values between keyframes are linearly interpolated,
+/// and frames outside of the keyframes take the value of the nearest keyframe.
+/// @param keyframes The keyframes to sample.
+/// @param frame The frame number to sample at, within the timeline of the layer containing the given keyframes.
+/// @returns The value of the given keyframes at the given frame.
+float aet_layer_keyframes_sample(const struct aet_layer_keyframes_t *keyframes, float frame);
+
+/// Get the given frame number on the timeline of the given layer's parent, as a frame number on the given layer's timeline.
+///
+/// This is the frame number that should be used when sampling the given layer's keyframes and markers,
+/// as well as the parent frame number for the given layer's children.
+/// @param layer The layer to get the frame number on the timeline of.
+/// @param parent_frame The frame number on the timeline of the given layer's parent.
+/// If the given layer has no parent, then this is the frame number on the containing composition's timeline.
+/// @returns The frame number on the given layer's timeline for the given parent frame number.
+float aet_layer_frame(const struct aet_layer_t *layer, float parent_frame);
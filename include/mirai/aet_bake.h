@@ -0,0 +1,132 @@
+//
+//  aet_bake.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "aet_timeline.h"
+#include "matrix.h"
+
+// MARK: - Data Structures
+
+/// The data structure for the baked state of a single visible layer at a single frame.
+///
+/// This is a compact form of `struct aet_layer_state_t`.
+struct aet_baked_layer_t
+{
+    /// The index of the layer that this state is of, within the composition's layers array.
+    uint16_t layer_index;
+
+    /// The index of the sprite to display from the layer's sprite group.
+    uint16_t sprite_index;
+
+    /// The opacity of the layer, including the opacity of all of it's parents.
+    float opacity;
+
+    /// The matrix transforming the pixel space of the layer's sprite group into the pixel space of the composition.
+    struct matrix2d_t world_matrix;
+};
+
+/// The data structure for a composition that has been sampled at a fixed rate into per-frame tables.
+///
+/// Once baked, playing back the composition is a lookup of the nearest baked frame,
+/// with no keyframe interpolation or hierarchy traversal.
+struct aet_bake_t
+{
+    /// The number of samples per second that the composition was baked at.
+    float frame_rate;
+
+    /// The frame number within the composition's timeline of the first sample.
+    float start_frame;
+
+    /// The number of composition frames between each sample.
+    float frame_step;
+
+    /// The total number of layers within the baked composition.
+    unsigned int num_layers;
+
+    /// The total number of samples within this bake.
+    unsigned int num_frames;
+
+    /// The index of the first baked layer of each sample within `layers`.
+    ///
+    /// This has an additional item at the end, so the layers of the sample at index `i`
+    /// are from `layer_offsets[i]` up until `layer_offsets[i + 1]`.
+    /// Allocated.
+    uint32_t *layer_offsets;
+
+    /// The total number of baked layers within this bake, across all samples.
+    unsigned int num_baked_layers;
+
+    /// The baked layers of every sample, with each sample's layers in draw order from back to front.
+    ///
+    /// Allocated.
+    struct aet_baked_layer_t *baked_layers;
+};
+
+// MARK: - Functions
+
+/// Bake the composition of the given timeline into the given bake.
+///
+/// The baking of samples is independent, so it can be spread over multiple threads.
+/// The resulting bake is the same regardless of the number of threads.
+/// @param timeline The timeline of the composition to bake.
+/// This does not need to be kept in memory once the bake has been created.
+/// @param frame_rate The number of samples per second to bake at.
+/// If this is `0` then the composition's own frame rate is used.
+/// @param num_threads The number of threads to bake with.
+/// If this is `0` or `1` then the calling thread is used.
+/// @param bake The bake to create.
+void aet_bake_create(const struct aet_timeline_t *timeline,
+                     float frame_rate,
+                     unsigned int num_threads,
+                     struct aet_bake_t *bake);
+
+/// Destroy the given bake, releasing all of it's allocated memory.
+/// @param bake The bake to destroy.
+void aet_bake_destroy(struct aet_bake_t *bake);
+
+/// Get the baked layers of the sample at the given index of the given bake.
+/// @param bake The bake to get the sample from.
+/// @param index The index of the sample to get.
+/// Clamped to the samples within the given bake.
+/// @param num_baked_layers The number of baked layers within the sample.
+/// @returns A pointer to the first baked layer of the sample, within the given bake.
+const struct aet_baked_layer_t *aet_bake_sample(const struct aet_bake_t *bake,
+                                                int index,
+                                                unsigned int *num_baked_layers);
+
+/// Get the baked layers of the sample nearest to, but not after, the given frame of the given bake.
+/// @param bake The bake to get the sample from.
+/// @param frame The frame number within the composition's timeline to get the sample of.
+/// @param num_baked_layers The number of baked layers within the sample.
+/// @returns A pointer to the first baked layer of the sample, within the given bake.
+const struct aet_baked_layer_t *aet_bake_lookup(const struct aet_bake_t *bake,
+                                                float frame,
+                                                unsigned int *num_baked_layers);
+
+/// Save the given bake to a file at the given path, so that it can be loaded again without rebaking.
+///
+/// The file is written in the host's byte order, so it should only be loaded on the same architecture.
+/// @param bake The bake to save.
+/// @param path The path of the file to write to.
+/// @returns Whether or not the bake was successfully written.
+int aet_bake_save(const struct aet_bake_t *bake, const char *path);
+
+/// Load the bake within the file at the given path, previously written by `aet_bake_save(bake, path)`.
+/// @param path The path of the file to load.
+/// @param timeline The timeline of the composition that the bake is expected to be of.
+/// This is used to reject bakes which are of a different composition,
+/// including any baked layer which is not of a sprite group layer or displays a sprite outside of it's group.
+/// @param bake The bake to load the file into.
+/// @returns Whether or not the bake was successfully loaded.
+/// If this is `0`, then the file is missing, corrupt, of a different version, or not of the expected composition,
+/// and the bake does not need to be destroyed.
+int aet_bake_load(const char *path, const struct aet_timeline_t *timeline, struct aet_bake_t *bake);
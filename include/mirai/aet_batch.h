@@ -0,0 +1,114 @@
+//
+//  aet_batch.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+
+#include "aet.h"
+#include "aet_timeline.h"
+#include "aet_state.h"
+#include "matrix.h"
+
+// MARK: - Data Structures
+
+/// The data structure for evaluating many instances of a single composition at once, each at their own frame.
+///
+/// The evaluated values are laid out with one row per layer and one column per instance,
+/// so the value for the layer at index `l` and the instance at index `i` is at `l * max_instances + i`.
+/// This keeps the values of each layer contiguous across instances,
+/// so that interpolating and transforming them all is a simple loop which the compiler can vectorize.
+struct aet_batch_t
+{
+    /// The timeline of the composition that this batch is evaluating.
+    const struct aet_timeline_t *timeline;
+
+    /// The number of instances that this batch has room for.
+    unsigned int max_instances;
+
+    /// The number of instances evaluated by the last evaluation.
+    unsigned int num_instances;
+
+    /// The frame number within the composition's timeline that each instance was last evaluated at.
+    ///
+    /// Allocated with room for `max_instances` items.
+    float *frames;
+
+    /// The frame number within each layer's own timeline, for each instance.
+    ///
+    /// Allocated with room for a row for every layer.
+    float *layer_frames;
+
+    /// The opacity of each layer, including the opacity of all of it's parents, for each instance.
+    ///
+    /// If a layer is not active for an instance, then it's opacity is `0`.
+    /// Allocated with room for a row for every layer.
+    float *opacities;
+
+    /// The index of the sprite to display from each layer's sprite group, for each instance.
+    ///
+    /// Only the items for sprite group layers are valid.
+    /// Allocated with room for a row for every layer.
+    unsigned int *sprite_indices;
+
+    /// The components of the world matrix of each layer, for each instance.
+    ///
+    /// See `struct matrix2d_t` for how these are applied.
+    /// Each is allocated with room for a row for every layer.
+    float *world_a, *world_b, *world_c, *world_d, *world_tx, *world_ty;
+
+    /// Scratch storage for the index of the keyframe before each instance's frame, while sampling keyframes.
+    ///
+    /// Allocated with room for `max_instances` items.
+    unsigned int *keyframe_indices;
+
+    /// Scratch storage for the keyframe positions and sampled values of the layer being evaluated.
+    ///
+    /// Allocated with room for eight rows.
+    float *scratch;
+};
+
+// MARK: - Functions
+
+/// Create a batch for evaluating instances of the composition of the given timeline.
+/// @param timeline The timeline of the composition to evaluate.
+/// This timeline must be kept in memory until the batch is destroyed.
+/// @param max_instances The maximum number of instances that can be evaluated at once.
+/// @param batch The batch to create.
+void aet_batch_create(const struct aet_timeline_t *timeline, unsigned int max_instances, struct aet_batch_t *batch);
+
+/// Destroy the given batch, releasing all of it's allocated memory.
+/// @param batch The batch to destroy.
+void aet_batch_destroy(struct aet_batch_t *batch);
+
+/// Evaluate the given number of instances of the given batch's composition.
+///
+/// Each layer is evaluated once for every instance together, rather than each instance walking the layers on it's own.
+/// The results for each instance are the same as those of `aet_state_evaluate(state, frame)`,
+/// with the world matrices of layers without a parent transformed by the instance's root matrix.
+/// @param batch The batch to evaluate into.
+/// @param num_instances The number of instances to evaluate, at most the batch's `max_instances`.
+/// @param frames The frame number within the composition's timeline to evaluate each instance at.
+/// @param root_matrices The matrix transforming the pixel space of the composition into the pixel space of each instance.
+/// If this is `NULL`, then every instance uses the identity matrix.
+void aet_batch_evaluate(struct aet_batch_t *batch,
+                        unsigned int num_instances,
+                        const float *frames,
+                        const struct matrix2d_t *root_matrices);
+
+/// Get the state of a single instance from the given evaluated batch.
+///
+/// This allows instances to be drawn with anything taking a state,
+/// such as `aet_draw_list_build(state, binding, list)`.
+/// @param batch The evaluated batch to get the state from.
+/// @param instance_index The index of the instance to get the state of.
+/// @param state The state to write the instance's visible layers into.
+/// This must have been created with the same timeline as the given batch.
+void aet_batch_instance_state(const struct aet_batch_t *batch,
+                              unsigned int instance_index,
+                              struct aet_state_t *state);
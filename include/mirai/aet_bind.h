@@ -0,0 +1,91 @@
+//
+//  aet_bind.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+
+#include "aet.h"
+#include "spr.h"
+
+// MARK: - Data Structures
+
+/// The data structure for a single SCR name of a composition, resolved to an SCR within an SPR.
+struct aet_scr_binding_t
+{
+    /// The SCR that this binding resolved to.
+    ///
+    /// This points to an item within the scrs array of the SPR at `spr_index`.
+    /// If the SCR name could not be resolved, then this is `NULL`.
+    const struct scr_t *scr;
+
+    /// The index of the SPR containing `scr`, within the SPRs that the composition was bound to.
+    unsigned int spr_index;
+
+    /// The index of the texture containing `scr`, within the SPR at `spr_index`.
+    unsigned int texture_index;
+};
+
+/// The data structure for a composition with all of it's SCR names resolved ahead of time.
+///
+/// Once bound, the SCR of any sprite is found directly through it's `scr_index`,
+/// see `aet_binding_sprite(binding, sprite)`, so no string operations are needed while drawing.
+struct aet_binding_t
+{
+    /// The composition that this binding is of.
+    const struct aet_composition_t *composition;
+
+    /// The total number of SPRs that the composition was bound to.
+    unsigned int num_sprs;
+
+    /// All the SPRs that the composition was bound to.
+    const struct spr_t *sprs;
+
+    /// The binding of each of the composition's SCR names, in the same order as `scr_names`.
+    ///
+    /// Allocated.
+    struct aet_scr_binding_t *scr_bindings;
+
+    /// The total number of SCR names which could not be resolved.
+    unsigned int num_unresolved;
+
+    /// The indices of the SCR names which could not be resolved, within the composition's `scr_names`.
+    ///
+    /// Allocated.
+    unsigned int *unresolved_indices;
+};
+
+// MARK: - Functions
+
+/// Bind the given composition to the given SPRs, resolving each of it's SCR names to an SCR once.
+///
+/// If an SCR name is within multiple of the given SPRs, then the first SPR containing it takes precedence.
+/// SCR names which are not within any of the given SPRs are reported within `unresolved_indices`,
+/// and are skipped when drawing.
+/// @param composition The composition to bind.
+/// The composition must be kept in memory until the binding is destroyed.
+/// @param num_sprs The total number of SPRs within the given array.
+/// @param sprs The SPRs to resolve the given composition's SCR names within.
+/// These must be kept open until the binding is destroyed.
+/// @param binding The binding to create.
+void aet_composition_bind(const struct aet_composition_t *composition,
+                          unsigned int num_sprs,
+                          const struct spr_t *sprs,
+                          struct aet_binding_t *binding);
+
+/// Destroy the given binding, releasing all of it's allocated memory.
+/// @param binding The binding to destroy.
+void aet_binding_destroy(struct aet_binding_t *binding);
+
+/// Get the binding of the SCR displayed by the given sprite.
+/// @param binding The binding of the composition containing the given sprite.
+/// @param sprite The sprite to get the binding of.
+/// @returns The binding of the SCR displayed by the given sprite.
+/// Note that this is a pointer within the given binding, so the binding must be within scope where it is used.
+const struct aet_scr_binding_t *aet_binding_sprite(const struct aet_binding_t *binding,
+                                                   const struct aet_sprite_t *sprite);
@@ -0,0 +1,127 @@
+//
+//  aet_draw.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "aet.h"
+#include "aet_state.h"
+#include "aet_bind.h"
+#include "color.h"
+
+// MARK: - Data Structures
+
+/// The data structure for a single vertex within a draw list.
+struct aet_draw_vertex_t
+{
+    /// The X position of this vertex within the composition's pixel space, with a top-left origin.
+    float x;
+
+    /// The Y position of this vertex within the composition's pixel space, with a top-left origin.
+    float y;
+
+    /// The U of this vertex's texture coordinate, taken from it's SCR's `start_u` and `end_u`.
+    ///
+    /// The same as the SCR's UV coordinates, this uses a top-left origin.
+    float u;
+
+    /// The V of this vertex's texture coordinate, taken from it's SCR's `start_v` and `end_v`.
+    ///
+    /// The same as the SCR's UV coordinates, this uses a top-left origin.
+    float v;
+
+    /// The colour to multiply this vertex's texels by.
+    ///
+    /// The red, green, and blue channels are the sprite group's multiply colour,
+    /// and the alpha channel is the layer's opacity.
+    struct color4_t color;
+};
+
+/// The data structure for a single draw call within a draw list.
+///
+/// Draw calls should be issued with non-premultiplied alpha blending,
+/// `SRC_ALPHA, ONE_MINUS_SRC_ALPHA` for `AET_LAYER_BLEND_MODE_NORMAL`,
+/// and `SRC_ALPHA, ONE` for `AET_LAYER_BLEND_MODE_ADD`.
+struct aet_draw_call_t
+{
+    /// The index of the SPR containing the texture to draw with, within the SPRs of the binding that the draw list was built from.
+    unsigned int spr_index;
+
+    /// The index of the texture to draw with, within the SPR at `spr_index`.
+    unsigned int texture_index;
+
+    /// The blend mode to draw with.
+    enum aet_layer_blend_mode_t blend_mode;
+
+    /// The index of this draw call's first index, within the draw list's indices.
+    uint32_t first_index;
+
+    /// The number of indices within this draw call, six for each quad.
+    uint32_t num_indices;
+};
+
+/// The data structure for a draw list, writing into buffers provided by the caller.
+///
+/// The buffers are never allocated or resized while building a draw list,
+/// so the same draw list can be rebuilt every frame without any allocations.
+struct aet_draw_list_t
+{
+    /// The buffer to write vertices into, four for each quad.
+    ///
+    /// Provided by the caller.
+    struct aet_draw_vertex_t *vertices;
+
+    /// The number of vertices that `vertices` has room for.
+    ///
+    /// As indices are 16-bit, no more than `65536` vertices are ever written.
+    unsigned int max_vertices;
+
+    /// The number of vertices written to `vertices` by the last build.
+    unsigned int num_vertices;
+
+    /// The buffer to write indices into, six for each quad, as two triangles.
+    ///
+    /// Provided by the caller.
+    uint16_t *indices;
+
+    /// The number of indices that `indices` has room for.
+    unsigned int max_indices;
+
+    /// The number of indices written to `indices` by the last build.
+    unsigned int num_indices;
+
+    /// The buffer to write draw calls into.
+    ///
+    /// Provided by the caller.
+    struct aet_draw_call_t *draw_calls;
+
+    /// The number of draw calls that `draw_calls` has room for.
+    unsigned int max_draw_calls;
+
+    /// The number of draw calls written to `draw_calls` by the last build.
+    unsigned int num_draw_calls;
+};
+
+// MARK: - Functions
+
+/// Build the given draw list from the given evaluated state.
+///
+/// Each visible sprite becomes a single quad, with it's SCR taken directly from the given binding.
+/// Sprites whose SCR could not be resolved by the binding are skipped.
+/// The quads are kept in draw order from back to front,
+/// and each run of adjacent quads sharing the same SPR, texture, and blend mode is merged into a single draw call.
+/// @param state The evaluated state of the composition to build the draw list of.
+/// @param binding The binding of the given state's composition.
+/// @param list The draw list to build into, replacing any of it's previous contents.
+/// @returns Whether or not every quad fit within the given draw list's buffers.
+/// If this is `0`, then the draw list contains only the quads which fit, from the back.
+int aet_draw_list_build(const struct aet_state_t *state,
+                        const struct aet_binding_t *binding,
+                        struct aet_draw_list_t *list);
@@ -0,0 +1,97 @@
+//
+//  aet_event.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+
+#include "aet.h"
+#include "aet_timeline.h"
+
+// MARK: - Data Structures
+
+/// The data structure for a single marker of a composition, placed on the composition's timeline.
+struct aet_event_t
+{
+    /// The frame number within the composition's timeline at which this event fires.
+    float frame;
+
+    /// The index of the layer containing this event's marker, within the composition's layers array.
+    unsigned int layer_index;
+
+    /// The marker that this event is of.
+    ///
+    /// This points to an item within the markers array of the layer at `layer_index`.
+    const struct aet_marker_t *marker;
+};
+
+/// The data structure for all the markers of a composition, merged into a single stream sorted by time.
+struct aet_event_stream_t
+{
+    /// The total number of events within this stream.
+    unsigned int num_events;
+
+    /// All the events within this stream, sorted by frame.
+    ///
+    /// Events of the same frame are ordered by their layer, and then by their order within the layer.
+    /// Allocated.
+    struct aet_event_t *events;
+};
+
+/// The data structure for tracking which events of a stream fire during playback.
+struct aet_event_cursor_t
+{
+    /// The stream that this cursor is over.
+    const struct aet_event_stream_t *stream;
+
+    /// The frame number within the composition's timeline that this cursor is currently at.
+    float frame;
+
+    /// The number of events within the stream that fire at or before `frame`.
+    unsigned int position;
+};
+
+// MARK: - Functions
+
+/// Create an event stream from all the markers of the given timeline's composition.
+///
+/// Each marker is mapped from the timeline of it's layer onto the composition's timeline,
+/// accounting for the timeline offset and speed of the layer and all of it's parents.
+/// Markers of layers whose timeline is frozen, with a speed of zero, are not included.
+/// @param timeline The timeline of the composition to create the event stream of.
+/// The composition must be kept in memory until the event stream is destroyed.
+/// @param stream The event stream to create.
+void aet_event_stream_create(const struct aet_timeline_t *timeline, struct aet_event_stream_t *stream);
+
+/// Destroy the given event stream, releasing all of it's allocated memory.
+/// @param stream The event stream to destroy.
+void aet_event_stream_destroy(struct aet_event_stream_t *stream);
+
+/// Move the given cursor to the given frame of the given event stream, without firing any events.
+///
+/// Events at or before the given frame are treated as having already fired.
+/// To fire events on the first frame of playback, seek to `-INFINITY` first.
+/// @param stream The event stream to place the cursor within.
+/// @param frame The frame number within the composition's timeline to place the cursor at.
+/// @param cursor The cursor to place.
+void aet_event_cursor_seek(const struct aet_event_stream_t *stream, float frame, struct aet_event_cursor_t *cursor);
+
+/// Move the given cursor forwards to the given frame, getting all the events fired along the way.
+///
+/// Events fire when the cursor moves from before their frame to at or after it.
+/// This only visits the fired events, so it is linear in the number of events that fire.
+/// If the given frame is before the cursor's current frame, such as when rewinding or looping,
+/// then no events fire and the cursor is instead placed at the given frame.
+/// @param cursor The cursor to move.
+/// @param frame The frame number within the composition's timeline to move the cursor to.
+/// @param num_events The number of events that fired.
+/// @returns A pointer to the first event that fired, within the cursor's event stream.
+/// All the fired events are contiguous from this event.
+const struct aet_event_t *aet_event_cursor_advance(struct aet_event_cursor_t *cursor,
+                                                   float frame,
+                                                   unsigned int *num_events);
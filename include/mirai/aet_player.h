@@ -0,0 +1,177 @@
+//
+//  aet_player.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "aet.h"
+#include "aet_timeline.h"
+
+// MARK: - Enumerations
+
+/// The different states that an AET player can be in.
+enum aet_player_state_t
+{
+    /// The player is playing the in transition.
+    AET_PLAYER_STATE_IN    = 0x0,
+
+    /// The player is repeating the loop animation.
+    AET_PLAYER_STATE_LOOP  = 0x1,
+
+    /// The player is playing the press animation, after which it returns to the loop animation.
+    AET_PLAYER_STATE_PRESS = 0x2,
+
+    /// The player is playing the out transition.
+    AET_PLAYER_STATE_OUT   = 0x3,
+
+    /// The player has finished the out transition, and is holding on it's last frame.
+    AET_PLAYER_STATE_DONE  = 0x4,
+};
+
+// MARK: - Data Structures
+
+/// The data structure for a range of frames defined by a pair of start and end markers.
+struct aet_marker_range_t
+{
+    /// Whether or not either marker of this range exists.
+    ///
+    /// If only one of the markers exists, then the other is taken from the bounds of the containing timeline.
+    int exists;
+
+    /// The frame number at which this range begins.
+    float start_frame;
+
+    /// The frame number at which this range ends.
+    float end_frame;
+};
+
+/// The data structure for the in, loop, out, and press ranges of a timeline.
+struct aet_marker_ranges_t
+{
+    /// The range of the in transition, from `ST_IN` to `ED_IN`.
+    struct aet_marker_range_t in;
+
+    /// The range of the loop animation, from `ST_LP` to `ED_LP`.
+    struct aet_marker_range_t loop;
+
+    /// The range of the out transition, from `ST_OUT` to `ED_OUT`.
+    struct aet_marker_range_t out;
+
+    /// The range of the press animation, from `ST_SP` to `ED_SP`.
+    struct aet_marker_range_t press;
+};
+
+/// The data structure for the precomputed marker ranges of a composition and all of it's layers.
+struct aet_marker_table_t
+{
+    /// The ranges of the composition, within the composition's timeline.
+    ///
+    /// These are gathered from the markers of every layer, with the first layer to define each marker taking precedence.
+    struct aet_marker_ranges_t composition_ranges;
+
+    /// The total number of layers within this table.
+    unsigned int num_layers;
+
+    /// The ranges of each layer, within each layer's own timeline.
+    ///
+    /// Allocated.
+    struct aet_marker_ranges_t *layer_ranges;
+};
+
+/// The data structure for a state machine playing through the ranges of a timeline.
+///
+/// Each step of the player is constant time regardless of how long it has been playing,
+/// and the loop position is recalculated from a step count rather than accumulated,
+/// so looping for hours does not drift.
+struct aet_player_t
+{
+    /// The ranges that this player is playing through.
+    struct aet_marker_ranges_t ranges;
+
+    /// The number of frames that each step advances by.
+    double frame_step;
+
+    /// The current state of this player.
+    enum aet_player_state_t state;
+
+    /// The frame number at which the current state began playing.
+    double state_start_frame;
+
+    /// The number of steps taken since the current state began playing.
+    uint64_t state_steps;
+
+    /// Whether or not the out transition has been requested,
+    /// to be played once the current press animation or in transition completes.
+    int out_requested;
+
+    /// Whether or not the press animation has been requested,
+    /// to be played once the current press animation or in transition completes.
+    int press_requested;
+
+    /// The frame number of the current step.
+    float frame;
+};
+
+// MARK: - Functions
+
+/// Create a marker table for the given timeline's composition.
+/// @param timeline The timeline of the composition to create the marker table of.
+/// @param table The marker table to create.
+void aet_marker_table_create(const struct aet_timeline_t *timeline, struct aet_marker_table_t *table);
+
+/// Destroy the given marker table, releasing all of it's allocated memory.
+/// @param table The marker table to destroy.
+void aet_marker_table_destroy(struct aet_marker_table_t *table);
+
+/// Get the ranges defined by the given markers.
+/// @param num_markers The total number of markers within the given array.
+/// @param markers The markers to get the ranges of.
+/// @param start_frame The first frame number of the timeline containing the given markers.
+/// @param end_frame The last frame number of the timeline containing the given markers.
+/// @param ranges The ranges to write to.
+void aet_marker_ranges_read(unsigned int num_markers,
+                            const struct aet_marker_t *markers,
+                            float start_frame,
+                            float end_frame,
+                            struct aet_marker_ranges_t *ranges);
+
+/// Create a player for playing through the given ranges.
+///
+/// The player begins at the start of the in transition.
+/// If there is no in transition then it begins with the loop animation,
+/// and if there is no loop animation it instead holds at the end of the in transition.
+/// @param ranges The ranges to play through.
+/// @param frame_step The number of frames that each step advances by.
+/// This is usually the timeline's frame rate divided by the display's refresh rate.
+/// @param player The player to create.
+void aet_player_create(const struct aet_marker_ranges_t *ranges, double frame_step, struct aet_player_t *player);
+
+/// Advance the given player by a single step.
+/// @param player The player to advance.
+/// @returns The frame number of the new step, which is also written to the given player's `frame`.
+float aet_player_step(struct aet_player_t *player);
+
+/// Begin playing the press animation of the given player.
+///
+/// If the player is looping then this begins on the next step.
+/// If the player is playing the in transition or press animation, then it begins once that completes,
+/// with any further presses until then combined into this one.
+/// If the out transition has also been requested, or there is no press animation, then this is ignored.
+/// Once the press animation completes, the player returns to the beginning of the loop animation.
+/// @param player The player to press.
+void aet_player_press(struct aet_player_t *player);
+
+/// Begin playing the out transition of the given player.
+///
+/// If the player is looping then this begins on the next step.
+/// If there is no out transition then the player instead holds at it's current frame.
+/// If the player is playing the in transition or press animation, then it begins once that completes.
+/// @param player The player to transition out.
+void aet_player_out(struct aet_player_t *player);
@@ -0,0 +1,70 @@
+//
+//  aet_render.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "aet.h"
+#include "aet_timeline.h"
+#include "aet_bind.h"
+#include "texture_cache.h"
+
+// MARK: - Functions
+
+/// Render the given timeline's composition at the given frame into the given buffer, entirely on the CPU.
+///
+/// This is a reference renderer for when there is no GPU available, such as for thumbnails or visual diffs.
+/// Each visible sprite's SCR is taken directly from the given binding, so no string operations are made while rendering,
+/// and is then drawn with bilinear filtering, transformed by it's layer's world matrix,
+/// and tinted by it's sprite group's multiply colour and it's layer's opacity.
+/// Sprites whose SCR could not be resolved by the binding are skipped.
+/// `AET_LAYER_BLEND_MODE_ADD` layers are blended additively, and all other layers with normal alpha blending.
+///
+/// The rendered frame is composited over the existing contents of the given buffer,
+/// so it should be cleared first for a transparent background.
+/// @param timeline The timeline of the composition to render.
+/// @param frame The frame number within the composition's timeline to render.
+/// @param binding The binding of the given timeline's composition, to the SPRs containing it's SCRs.
+/// @param cache The texture cache to get the unpacked textures used by the frame from.
+/// Textures are kept pinned within the cache until the render finishes.
+/// @param out_rgba The buffer to render into, of `width * height` 8-bit red, green, blue, and alpha pixels.
+/// The width and height are those of the given timeline's composition, and rows are ordered top to bottom.
+/// Colours are premultiplied by alpha, so that blending matches `ONE, ONE_MINUS_SRC_ALPHA` on a GPU.
+/// @param stride The number of bytes between the beginning of each row within the given buffer.
+void aet_composition_render(const struct aet_timeline_t *timeline,
+                            float frame,
+                            const struct aet_binding_t *binding,
+                            struct texture_cache_t *cache,
+                            uint8_t *out_rgba,
+                            size_t stride);
+
+/// Render the given timeline's composition at the given frame into the given buffer, split into tiles over multiple threads.
+///
+/// The render target is split into 64x64 pixel tiles, and each sprite is binned into every tile that it overlaps.
+/// The textures used by the frame are first acquired from the given texture cache in parallel,
+/// so any that are not already cached are decoded across all the threads.
+/// The tiles are then rendered in parallel, with each thread stealing tiles from the others once it runs out.
+/// Sprites are always drawn back to front within each tile,
+/// so the output is identical to `aet_composition_render(timeline, frame, binding, cache, out_rgba, stride)`,
+/// regardless of the number of threads.
+///
+/// The timeline, binding, and texture cache are only read from, or are thread-safe, so they can be created once
+/// and shared by every frame of an export, and by multiple renders at once.
+/// See `aet_composition_render(timeline, frame, binding, cache, out_rgba, stride)` for parameter information.
+/// @param num_threads The number of threads to render with.
+/// If this is `0` or `1` then the calling thread is used.
+/// If any thread cannot be created, then it's share of the work is done by the calling thread instead.
+void aet_composition_render_binned(const struct aet_timeline_t *timeline,
+                                   float frame,
+                                   const struct aet_binding_t *binding,
+                                   struct texture_cache_t *cache,
+                                   uint8_t *out_rgba,
+                                   size_t stride,
+                                   unsigned int num_threads);
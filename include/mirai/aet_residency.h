@@ -0,0 +1,189 @@
+//
+//  aet_residency.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "aet.h"
+#include "aet_timeline.h"
+#include "aet_bind.h"
+#include "allocator.h"
+
+// MARK: - Data Structures
+
+/// The data structure for a reference to a single texture within the SPRs of a binding.
+struct aet_texture_ref_t
+{
+    /// The index of the SPR containing the texture, within the SPRs of the binding.
+    unsigned int spr_index;
+
+    /// The index of the texture, within the SPR at `spr_index`.
+    unsigned int texture_index;
+};
+
+/// The data structure for a range of frames throughout which the same set of textures is needed.
+struct aet_residency_segment_t
+{
+    /// The frame number at which this segment begins, inclusive.
+    float start_frame;
+
+    /// The frame number at which this segment ends, exclusive.
+    float end_frame;
+
+    /// The index of the first texture needed throughout this segment, within the plan's `textures`.
+    unsigned int first_texture;
+
+    /// The number of textures needed throughout this segment.
+    unsigned int num_textures;
+};
+
+/// The data structure for the textures needed by a composition throughout it's timeline.
+///
+/// Textures are considered needed whenever a layer could display one of it's SCRs,
+/// regardless of it's opacity or position.
+struct aet_residency_plan_t
+{
+    /// The total number of segments within this plan.
+    unsigned int num_segments;
+
+    /// All the segments within this plan, sorted by frame and without any gaps between them.
+    ///
+    /// Adjacent segments always need different sets of textures.
+    /// Allocated.
+    struct aet_residency_segment_t *segments;
+
+    /// The total number of texture references within this plan.
+    unsigned int num_textures;
+
+    /// The textures needed by each segment, with each segment's textures sorted by SPR and then by texture.
+    ///
+    /// Allocated.
+    struct aet_texture_ref_t *textures;
+};
+
+/// The data structure for a background thread decoding the textures of a residency plan ahead of playback.
+///
+/// While a prefetcher is running, it reads from the files of the binding's SPRs while holding their locks,
+/// so anything else reading from these files at the same time must also hold their locks with `flockfile`.
+struct aet_prefetcher_t
+{
+    /// The plan of the textures to prefetch.
+    const struct aet_residency_plan_t *plan;
+
+    /// The binding containing the SPRs of the textures to prefetch.
+    const struct aet_binding_t *binding;
+
+    /// The number of frames ahead of the current frame to keep decoded.
+    float lookahead;
+
+    /// The index of the first texture of each SPR within `textures`.
+    ///
+    /// Allocated.
+    unsigned int *texture_offsets;
+
+    /// The total number of textures within all the SPRs.
+    unsigned int num_textures;
+
+    /// The unpacked 8-bit red, green, blue, and alpha data of each texture, if it is resident.
+    ///
+    /// Textures which are not resident are `NULL`.
+    /// The array and each item are allocated.
+    uint8_t **textures;
+
+    /// Whether or not each texture is needed within the current lookahead window.
+    ///
+    /// Allocated.
+    uint8_t *wanted;
+
+    /// The frame number that playback is currently at.
+    float frame;
+
+    /// Whether or not the background thread should keep running.
+    int running;
+
+    /// The allocator of the thread that created this prefetcher, for the background thread to allocate with.
+    const struct allocator_t *allocator;
+
+    /// The background thread decoding textures.
+    ///
+    /// Only valid if `started` is set.
+    pthread_t thread;
+
+    /// Whether or not the background thread was successfully started.
+    int started;
+
+    /// The mutex guarding every other field of this prefetcher.
+    pthread_mutex_t mutex;
+
+    /// The condition signalled whenever the current frame changes or the prefetcher is destroyed.
+    pthread_cond_t condition;
+};
+
+// MARK: - Functions
+
+/// Create a residency plan for the given timeline's composition.
+///
+/// Each sprite group layer needs the textures of it's sprites throughout it's active range,
+/// and for flipbook sprite groups each sprite is only needed throughout the frames that it is displayed.
+/// @param timeline The timeline of the composition to plan the textures of.
+/// @param binding The binding of the given timeline's composition.
+/// @param plan The plan to create.
+void aet_residency_plan_create(const struct aet_timeline_t *timeline,
+                               const struct aet_binding_t *binding,
+                               struct aet_residency_plan_t *plan);
+
+/// Destroy the given residency plan, releasing all of it's allocated memory.
+/// @param plan The plan to destroy.
+void aet_residency_plan_destroy(struct aet_residency_plan_t *plan);
+
+/// Get the segment of the given residency plan containing the given frame.
+/// @param plan The plan to get the segment from.
+/// @param frame The frame number within the composition's timeline to get the segment of.
+/// @returns The segment containing the given frame, if any.
+/// If the given frame is outside of every segment, then this is `NULL`.
+const struct aet_residency_segment_t *aet_residency_plan_lookup(const struct aet_residency_plan_t *plan, float frame);
+
+/// Create a prefetcher for the given residency plan, and start it's background thread.
+/// @param plan The plan of the textures to prefetch.
+/// This must be kept in memory until the prefetcher is destroyed.
+/// @param binding The binding containing the SPRs of the given plan's textures.
+/// This must be kept in memory until the prefetcher is destroyed.
+/// @param lookahead The number of frames ahead of the current frame to keep decoded.
+/// @param prefetcher The prefetcher to create.
+/// It begins at the start of the given plan.
+/// If the background thread cannot be started, then no textures ever become resident.
+void aet_prefetcher_create(const struct aet_residency_plan_t *plan,
+                           const struct aet_binding_t *binding,
+                           float lookahead,
+                           struct aet_prefetcher_t *prefetcher);
+
+/// Stop the given prefetcher's background thread and destroy it, releasing all of it's allocated memory.
+/// @param prefetcher The prefetcher to destroy.
+void aet_prefetcher_destroy(struct aet_prefetcher_t *prefetcher);
+
+/// Move the given prefetcher to the given frame.
+///
+/// Textures which are no longer needed within the lookahead window from the given frame are evicted,
+/// and the background thread begins decoding any newly needed textures, nearest first.
+/// @param prefetcher The prefetcher to move.
+/// @param frame The frame number within the composition's timeline that playback is now at.
+void aet_prefetcher_update(struct aet_prefetcher_t *prefetcher, float frame);
+
+/// Get the unpacked data of the given texture from the given prefetcher, if it has been decoded.
+/// @param prefetcher The prefetcher to get the texture from.
+/// @param spr_index The index of the SPR containing the texture, within the SPRs of the prefetcher's binding.
+/// @param texture_index The index of the texture, within the SPR at the given index.
+/// @returns The unpacked 8-bit red, green, blue, and alpha data of the given texture, if it is resident.
+/// This remains valid until the next time the prefetcher is updated or destroyed.
+/// If the given texture is not resident, then this is `NULL`.
+const uint8_t *aet_prefetcher_texture(struct aet_prefetcher_t *prefetcher,
+                                      unsigned int spr_index,
+                                      unsigned int texture_index);
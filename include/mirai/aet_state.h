@@ -0,0 +1,101 @@
+//
+//  aet_state.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+
+#include "aet.h"
+#include "aet_timeline.h"
+#include "matrix.h"
+
+// MARK: - Data Structures
+
+/// The data structure for the evaluated state of a single visible layer within a composition.
+struct aet_layer_state_t
+{
+    /// The index of the layer that this state is of, within the composition's layers array.
+    unsigned int layer_index;
+
+    /// The index of the sprite to display from the layer's sprite group.
+    unsigned int sprite_index;
+
+    /// The opacity of the layer, including the opacity of all of it's parents.
+    float opacity;
+
+    /// The matrix transforming the pixel space of the layer's sprite group into the pixel space of the composition.
+    ///
+    /// The sprite group covers from `(0, 0)` to `(width, height)` within it's own pixel space.
+    struct matrix2d_t world_matrix;
+};
+
+/// The data structure for the evaluated state of a composition at a single frame.
+///
+/// Only layers which source a sprite group and are visible at the evaluated frame have a layer state.
+struct aet_state_t
+{
+    /// The timeline of the composition that this state is evaluating.
+    const struct aet_timeline_t *timeline;
+
+    /// The frame number within the composition's timeline that this state was last evaluated at.
+    float frame;
+
+    /// The total number of visible layers within this state.
+    unsigned int num_layer_states;
+
+    /// The states of all the visible layers, in draw order from back to front.
+    ///
+    /// Allocated with room for every layer within the composition.
+    struct aet_layer_state_t *layer_states;
+
+    /// Scratch storage for the indices of the active layers while evaluating.
+    ///
+    /// Allocated.
+    unsigned int *active_layer_indices;
+
+    /// Scratch storage for the world matrix of every layer while evaluating.
+    ///
+    /// Only the items for active layers are valid.
+    /// Allocated.
+    struct matrix2d_t *world_matrices;
+
+    /// Scratch storage for the opacity of every layer while evaluating.
+    ///
+    /// Only the items for active layers are valid.
+    /// Allocated.
+    float *opacities;
+};
+
+// MARK: - Functions
+
+/// Create a state for evaluating the composition of the given timeline.
+/// @param timeline The timeline of the composition to evaluate.
+/// This timeline must be kept in memory until the state is destroyed.
+/// @param state The state to create.
+void aet_state_create(const struct aet_timeline_t *timeline, struct aet_state_t *state);
+
+/// Destroy the given state, releasing all of it's allocated memory.
+/// @param state The state to destroy.
+void aet_state_destroy(struct aet_state_t *state);
+
+/// Evaluate the given state's composition at the given frame.
+///
+/// Only the layers which are active at the given frame are evaluated.
+/// Keyframes are interpolated linearly, see `aet_layer_keyframes_sample(keyframes, frame)`.
+/// @param state The state to evaluate into.
+/// @param frame The frame number within the composition's timeline to evaluate at.
+void aet_state_evaluate(struct aet_state_t *state, float frame);
+
+/// Get the local transform matrix of the given layer at the given frame.
+///
+/// This applies, in order, the anchor point, scale, rotation, and position of the given layer.
+/// Scales are normalized, where `1` is 100%, the same as the layer's timeline speed.
+/// @param layer The layer to get the transform matrix of.
+/// @param layer_frame The frame number within the given layer's own timeline to get the transform matrix at.
+/// @returns The matrix transforming the given layer's pixel space into the pixel space of it's parent.
+struct matrix2d_t aet_layer_matrix(const struct aet_layer_t *layer, float layer_frame);
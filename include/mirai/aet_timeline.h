@@ -0,0 +1,162 @@
+//
+//  aet_timeline.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+
+#include "aet.h"
+
+// MARK: - Data Structures
+
+/// The data structure for an index of when each layer within a composition is active.
+///
+/// Layers are active from their start frame, inclusive, until their end frame, exclusive.
+/// All the frames within a timeline are frame numbers on the indexed composition's timeline,
+/// with the timelines of child layers already resolved through their parents.
+struct aet_timeline_t
+{
+    /// The composition that this timeline indexes.
+    const struct aet_composition_t *composition;
+
+    /// The total number of layers within this timeline.
+    ///
+    /// This is always the same as the number of layers within the indexed composition.
+    unsigned int num_layers;
+
+    /// The index of the parent of each layer, within the indexed composition's layers array.
+    ///
+    /// If a layer has no parent, then its parent index is `UINT_MAX`.
+    /// Allocated.
+    unsigned int *parent_indices;
+
+    /// The frame number at which each layer becomes active, within the indexed composition's timeline.
+    ///
+    /// Allocated.
+    float *start_frames;
+
+    /// The frame number at which each layer stops being active, within the indexed composition's timeline.
+    ///
+    /// Allocated.
+    float *end_frames;
+
+    /// The scale of the mapping from the indexed composition's timeline to each layer's own timeline.
+    ///
+    /// A frame number on the composition's timeline maps to `frame * frame_scales[i] + frame_offsets[i]`
+    /// on the timeline of the layer at index `i`, which is the frame its keyframes and markers are sampled at.
+    /// Allocated.
+    float *frame_scales;
+
+    /// The offset of the mapping from the indexed composition's timeline to each layer's own timeline.
+    ///
+    /// See `frame_scales` for how this is applied.
+    /// Allocated.
+    float *frame_offsets;
+
+    /// The index of each layer within `draw_order`.
+    ///
+    /// Allocated.
+    unsigned int *draw_ranks;
+
+    /// The indices of all the layers within the indexed composition, in the order they are drawn, from back to front.
+    ///
+    /// Null object layers are ordered directly before their children.
+    /// Allocated.
+    unsigned int *draw_order;
+
+    /// The indices of all the layers within the indexed composition, sorted by their start frame.
+    ///
+    /// Allocated.
+    unsigned int *start_order;
+
+    /// The indices of all the layers within the indexed composition, sorted by their end frame.
+    ///
+    /// Allocated.
+    unsigned int *end_order;
+
+    /// The number of leaves within `max_end_frames`.
+    unsigned int num_tree_leaves;
+
+    /// An implicit binary tree over `start_order`, where each node holds the largest end frame beneath it.
+    ///
+    /// The root is at index `1`, and the children of each node `i` are at `2i` and `2i + 1`.
+    /// Allocated.
+    float *max_end_frames;
+};
+
+/// The data structure for tracking the layers that enter and exit a timeline during playback.
+struct aet_timeline_cursor_t
+{
+    /// The timeline that this cursor is over.
+    const struct aet_timeline_t *timeline;
+
+    /// The frame number that this cursor is currently at, within the composition's timeline.
+    float frame;
+
+    /// The number of items within the timeline's `start_order` that start at or before `frame`.
+    unsigned int start_position;
+
+    /// The number of items within the timeline's `end_order` that end at or before `frame`.
+    unsigned int end_position;
+};
+
+// MARK: - Functions
+
+/// Create a timeline indexing the active layers of the given composition.
+/// @param composition The composition to index.
+/// This composition must be kept in memory until the timeline is destroyed.
+/// @param timeline The timeline to create the index into.
+void aet_timeline_create(const struct aet_composition_t *composition, struct aet_timeline_t *timeline);
+
+/// Destroy the given timeline, releasing all of it's allocated memory.
+/// @param timeline The timeline to destroy.
+void aet_timeline_destroy(struct aet_timeline_t *timeline);
+
+/// Get whether the layer at the given index is active at the given frame of the given timeline.
+/// @param timeline The timeline to check within.
+/// @param layer_index The index of the layer to check.
+/// @param frame The frame number within the composition's timeline to check at.
+/// @returns Whether the layer at the given index is active at the given frame.
+int aet_timeline_layer_active(const struct aet_timeline_t *timeline, unsigned int layer_index, float frame);
+
+/// Get the indices of all the layers that are active at the given frame of the given timeline.
+///
+/// This only visits the layers which start at or before the given frame and have not yet ended.
+/// @param timeline The timeline to get the active layers of.
+/// @param frame The frame number within the composition's timeline to get the active layers at.
+/// @param layer_indices The array to write the active layer indices to, in draw order from back to front.
+/// This must have room for at least `num_layers` items.
+/// @returns The number of layer indices that were written to the given array.
+unsigned int aet_timeline_active(const struct aet_timeline_t *timeline, float frame, unsigned int *layer_indices);
+
+/// Move the given cursor to the given frame of the given timeline, discarding any previous position.
+/// @param timeline The timeline to place the cursor within.
+/// @param frame The frame number within the composition's timeline to place the cursor at.
+/// @param cursor The cursor to place.
+void aet_timeline_cursor_seek(const struct aet_timeline_t *timeline, float frame, struct aet_timeline_cursor_t *cursor);
+
+/// Move the given cursor to the given frame, getting the layers which became active and inactive along the way.
+///
+/// This only visits the layers which start or end between the cursor's current frame and the given frame,
+/// so stepping through playback frame by frame never iterates over layers that are unaffected.
+/// The given frame may be before the cursor's current frame, such as when rewinding.
+/// Layers which both become active and inactive between the two frames are reported in neither array.
+/// @param cursor The cursor to move.
+/// @param frame The frame number within the composition's timeline to move the cursor to.
+/// @param entered_layer_indices The array to write the indices of layers which became active to.
+/// This must have room for at least `num_layers` items.
+/// @param num_entered The number of layer indices written to the given entered array.
+/// @param exited_layer_indices The array to write the indices of layers which became inactive to.
+/// This must have room for at least `num_layers` items.
+/// @param num_exited The number of layer indices written to the given exited array.
+void aet_timeline_cursor_advance(struct aet_timeline_cursor_t *cursor,
+                                 float frame,
+                                 unsigned int *entered_layer_indices,
+                                 unsigned int *num_entered,
+                                 unsigned int *exited_layer_indices,
+                                 unsigned int *num_exited);
@@ -0,0 +1,80 @@
+//
+//  allocator.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+
+// MARK: - Data Structures
+
+/// The data structure for a set of functions that the library allocates all of it's memory through.
+///
+/// Every allocation made by the library, including the data returned to callers, goes through the current allocator,
+/// so callers can account for or pool every byte.
+/// Memory that the library documents as allocated must be freed with `allocator_free(pointer)`.
+struct allocator_t
+{
+    /// Allocate a block of memory of the given size, the same as `malloc`.
+    void *(*allocate)(size_t size, void *context);
+
+    /// Resize the given block of memory to the given size, the same as `realloc`.
+    void *(*reallocate)(void *pointer, size_t size, void *context);
+
+    /// Release the given block of memory, the same as `free`.
+    ///
+    /// This is never called with `NULL`.
+    void (*release)(void *pointer, void *context);
+
+    /// The context passed to each of this allocator's functions.
+    void *context;
+};
+
+// MARK: - Functions
+
+/// Set the allocator used by all threads that have not set their own.
+///
+/// This should be set before any memory is allocated by the library, as memory must be freed by the allocator that allocated it.
+/// @param allocator The allocator to use, or `NULL` to use the standard library.
+/// The allocator must be kept in memory while it is in use.
+void allocator_set_global(const struct allocator_t *allocator);
+
+/// Set the allocator used by the calling thread, overriding the global allocator.
+///
+/// This allows using an allocator for individual calls, by setting it before the call and restoring the previous allocator after.
+/// Memory allocated under an allocator must be freed under the same allocator,
+/// so objects must be destroyed with the same allocator set as they were created with.
+/// Threads started by the library use the allocator of the thread that started them.
+/// @param allocator The allocator to use, or `NULL` to use the global allocator.
+/// The allocator must be kept in memory while it is in use.
+/// @returns The allocator that the calling thread was previously using, or `NULL` if it was using the global allocator.
+const struct allocator_t *allocator_set_thread(const struct allocator_t *allocator);
+
+/// Get the allocator currently used by the calling thread.
+/// @returns The allocator of the calling thread, or `NULL` if it is using the global allocator.
+const struct allocator_t *allocator_get_thread(void);
+
+/// Allocate a block of memory of the given size with the calling thread's allocator, the same as `malloc`.
+/// @param size The size of the block to allocate, in bytes.
+/// @returns A pointer to the allocated block.
+void *allocator_malloc(size_t size);
+
+/// Allocate a zeroed block of memory for the given number of items with the calling thread's allocator, the same as `calloc`.
+/// @param count The number of items to allocate.
+/// @param size The size of each item, in bytes.
+/// @returns A pointer to the allocated block.
+void *allocator_calloc(size_t count, size_t size);
+
+/// Resize the given block of memory with the calling thread's allocator, the same as `realloc`.
+/// @param pointer The block to resize, or `NULL` to allocate a new block.
+/// @param size The new size of the block, in bytes.
+/// @returns A pointer to the resized block.
+void *allocator_realloc(void *pointer, size_t size);
+
+/// Free the given block of memory with the calling thread's allocator, the same as `free`.
+/// @param pointer The block to free, or `NULL` to do nothing.
+void allocator_free(void *pointer);
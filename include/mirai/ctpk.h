@@ -9,6 +9,7 @@
 #pragma once
 
 #include <stdio.h>
+#include <stdint.h>
 
 #include "ctr_texture.h"
 
@@ -26,6 +27,63 @@ struct ctpk_t
     struct ctr_texture_t *textures;
 };
 
+/// The data structure for a single item of the hash section of a CTPK file.
+struct ctpk_hash_t
+{
+    /// The CRC32 of the texture's name, see `utils_crc32(data, size)`.
+    uint32_t hash;
+
+    /// The index of the texture, within the CTPK's textures.
+    unsigned int index;
+};
+
+/// The data structure for a single texture within a CTPK file, which is only read once it is accessed.
+struct ctpk_file_entry_t
+{
+    /// Whether or not this entry has been read yet.
+    int read;
+
+    /// The texture of this entry.
+    ///
+    /// Only valid once `read` is set.
+    struct ctr_texture_t texture;
+
+    /// The name of this entry's texture, as stored within the CTPK.
+    ///
+    /// Only valid once `read` is set.
+    /// Allocated.
+    char *name;
+};
+
+/// The data structure for a standalone CTPK file that has been opened.
+///
+/// Unlike `struct ctpk_t`, the textures are only read as they are accessed,
+/// and textures can be looked up by name through the CTPK's hash section in logarithmic time.
+/// As textures are read lazily, accessing a CTPK file is not thread safe.
+struct ctpk_file_t
+{
+    /// The file handle for the file that this CTPK is reading data from.
+    ///
+    /// Kept open until `ctpk_file_close(ctpk)` is called with this CTPK.
+    FILE *file;
+
+    /// The total number of textures within this CTPK.
+    unsigned int num_textures;
+
+    /// The offset of this CTPK's texture data within the file, in bytes.
+    uint32_t data_base_pointer;
+
+    /// The hash section of this CTPK, sorted by hash.
+    ///
+    /// Allocated.
+    struct ctpk_hash_t *hashes;
+
+    /// The entries of each texture within this CTPK.
+    ///
+    /// Allocated.
+    struct ctpk_file_entry_t *entries;
+};
+
 // MARK: - Functions
 
 /// Open the CTPK file at the current offset of the given file handle into the given CTPK.
@@ -38,3 +96,35 @@ void ctpk_open(FILE *file, struct ctpk_t *ctpk);
 /// This must be called after a CTPK is opened and before program execution completes.
 /// @param ctpk The CTPK to close.
 void ctpk_close(struct ctpk_t *ctpk);
+
+/// Open the standalone CTPK file at the given path into the given CTPK file.
+///
+/// Only the header and hash section are read, and each texture is read once it is first accessed.
+/// @param path The path of the CTPK file to open.
+/// @param ctpk The CTPK file to open the file into.
+void ctpk_file_open(const char *path, struct ctpk_file_t *ctpk);
+
+/// Close the given CTPK file, releasing all of it's allocated memory and closing it's file handle.
+/// @param ctpk The CTPK file to close.
+void ctpk_file_close(struct ctpk_file_t *ctpk);
+
+/// Get the texture at the given index within the given CTPK file, reading it if it has not been read yet.
+/// @param ctpk The CTPK file to get the texture from.
+/// @param index The index of the texture, which must be less than `num_textures`.
+/// @returns The texture at the given index, which is valid until the CTPK file is closed.
+const struct ctr_texture_t *ctpk_file_texture(struct ctpk_file_t *ctpk, unsigned int index);
+
+/// Get the name of the texture at the given index within the given CTPK file, reading it if it has not been read yet.
+/// @param ctpk The CTPK file to get the texture name from.
+/// @param index The index of the texture, which must be less than `num_textures`.
+/// @returns The name of the texture at the given index, which is valid until the CTPK file is closed.
+const char *ctpk_file_texture_name(struct ctpk_file_t *ctpk, unsigned int index);
+
+/// Find the texture with the given name within the given CTPK file.
+///
+/// The name is hashed and looked up within the CTPK's hash section,
+/// so only the textures with the same hash are read and compared.
+/// @param ctpk The CTPK file to find the texture within.
+/// @param name The name of the texture to find, as stored within the CTPK.
+/// @returns The index of the texture with the given name, or `-1` if there is no such texture.
+int ctpk_file_find(struct ctpk_file_t *ctpk, const char *name);
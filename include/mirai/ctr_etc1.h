@@ -0,0 +1,58 @@
+//
+//  ctr_etc1.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "ctr_texture.h"
+
+// MARK: - Enumerations
+
+/// The different formats that the separate alpha plane of an ETC1_A4 texture can be read in.
+enum ctr_etc1_alpha_format_t
+{
+    /// Eight bits per pixel, expanded from four bits.
+    CTR_ETC1_ALPHA_FORMAT_A8 = 0x0,
+
+    /// Four bits per pixel, as stored, with two pixels per byte.
+    /// The left pixel of each pair is in the low four bits.
+    CTR_ETC1_ALPHA_FORMAT_A4 = 0x1,
+};
+
+// MARK: - Functions
+
+/// Read the compressed blocks of the given ETC1 or ETC1_A4 CTR texture, without decoding any pixels.
+///
+/// CTR textures store their 4x4 ETC1 blocks byte reversed and grouped into 8x8 tiles.
+/// This reorders them into the standard layout, with each block big endian and the blocks ordered left to right,
+/// then top to bottom, so they can be uploaded directly as `GL_ETC1_RGB8_OES` or written to a KTX or PKM file.
+/// Like `ctr_texture_decode(texture, file)`, the first row of blocks is the top of the texture.
+/// @param texture The CTR texture to read the blocks of, which must be either `CTR_TEXTURE_FORMAT_ETC1` or `CTR_TEXTURE_FORMAT_ETC1_A4`.
+/// @param file The file handle to read the CTR texture's data from.
+/// @param alpha_format The format to read the alpha plane in, if the texture is `CTR_TEXTURE_FORMAT_ETC1_A4`.
+/// @param alpha The pointer to write the texture's alpha plane to, if the texture is `CTR_TEXTURE_FORMAT_ETC1_A4`.
+/// This is ordered top to bottom, with each row left to right, and is `NULL` for `CTR_TEXTURE_FORMAT_ETC1` textures.
+/// The plane is allocated so it must be freed with `allocator_free(pointer)`.
+/// If this is `NULL` then the alpha plane is not read.
+/// @returns The ETC1 blocks of the given CTR texture, which are `width * height / 2` bytes.
+/// Allocated.
+uint8_t *ctr_etc1_read(const struct ctr_texture_t *texture,
+                       FILE *file,
+                       enum ctr_etc1_alpha_format_t alpha_format,
+                       uint8_t **alpha);
+
+/// Write the given ETC1 blocks to the given file handle as a KTX file.
+///
+/// The file contains a single `GL_ETC1_RGB8_OES` image with no mipmaps or key-value data.
+/// @param blocks The ETC1 blocks to write, as returned by `ctr_etc1_read(texture, file, alpha_format, alpha)`.
+/// @param width The width of the image, in pixels.
+/// @param height The height of the image, in pixels.
+/// @param file The file handle to write the KTX file to.
+void ctr_etc1_write_ktx(const uint8_t *blocks, unsigned int width, unsigned int height, FILE *file);
@@ -0,0 +1,113 @@
+//
+//  ctr_sampler.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "ctr_texture.h"
+
+// MARK: - Data Structures
+
+/// The data structure for a single decoded tile held within a sampler's cache.
+struct ctr_sampler_tile_t
+{
+    /// The index of the tile that this entry holds, within the texture's tiles, or `-1` if it is empty.
+    int tile_index;
+
+    /// The unpacked 8-bit red, green, blue, and alpha channels of this entry's tile,
+    /// ordered top to bottom with each row left to right.
+    uint8_t texels[8 * 8 * 4];
+};
+
+/// The data structure for sampling a CTR texture while keeping it encoded in memory.
+///
+/// Only the 8x8 tiles that are sampled are decoded, and the most recently decoded tiles are cached,
+/// so sampling small parts of a large texture costs a fraction of decoding it entirely.
+/// Pixels are addressed directly within the texture's tiles, so the texture is never untiled.
+/// Samplers are not thread safe, as sampling updates the cache.
+struct ctr_sampler_t
+{
+    /// The texture that this sampler samples.
+    const struct ctr_texture_t *texture;
+
+    /// The encoded data of this sampler's texture.
+    ///
+    /// Allocated.
+    uint8_t *encoded;
+
+    /// The total number of tiles within this sampler's cache.
+    unsigned int num_cached_tiles;
+
+    /// All the tiles within this sampler's cache.
+    ///
+    /// Each tile of the texture can only be cached within a single entry, at it's index modulo the number of entries.
+    /// Allocated.
+    struct ctr_sampler_tile_t *cached_tiles;
+};
+
+// MARK: - Functions
+
+/// Create a sampler for the given texture, reading it's encoded data from the given file handle.
+/// @param texture The texture to sample.
+/// The texture must be kept in memory until the sampler is destroyed.
+/// @param file The file handle to read the given texture's encoded data from.
+/// @param num_cached_tiles The number of decoded tiles to cache at most.
+/// This should be at least the width of the texture in tiles for sampling in rows to stay within the cache.
+/// @param sampler The sampler to create.
+void ctr_sampler_create(const struct ctr_texture_t *texture,
+                        FILE *file,
+                        unsigned int num_cached_tiles,
+                        struct ctr_sampler_t *sampler);
+
+/// Destroy the given sampler, releasing all of it's allocated memory.
+/// @param sampler The sampler to destroy.
+void ctr_sampler_destroy(struct ctr_sampler_t *sampler);
+
+/// Get the pixel at the given position within the given sampler's texture.
+/// @param sampler The sampler to get the pixel from.
+/// @param x The X position of the pixel, which must be within the texture.
+/// @param y The Y position of the pixel, which must be within the texture, from the top of the texture.
+/// @returns A pointer to the unpacked 8-bit red, green, blue, and alpha channels of the pixel.
+/// This is only valid until the sampler is next used.
+const uint8_t *ctr_sampler_texel(struct ctr_sampler_t *sampler, unsigned int x, unsigned int y);
+
+/// Sample the given sampler's texture at the given coordinate, using the nearest pixel.
+/// @param sampler The sampler to sample.
+/// @param u The horizontal coordinate to sample, from `0` at the left edge to `1` at the right.
+/// Coordinates outside the texture are clamped to it's edges.
+/// @param v The vertical coordinate to sample, from `0` at the top edge to `1` at the bottom.
+/// This uses a top-left origin, the same as SCR UV coordinates.
+/// @param rgba The 4 bytes to write the sampled 8-bit red, green, blue, and alpha channels to.
+void ctr_sampler_sample_point(struct ctr_sampler_t *sampler, float u, float v, uint8_t *rgba);
+
+/// Sample the given sampler's texture at the given coordinate, bilinearly filtering the nearest four pixels.
+///
+/// See `ctr_sampler_sample_point(sampler, u, v, rgba)` for parameter information.
+void ctr_sampler_sample_bilinear(struct ctr_sampler_t *sampler, float u, float v, uint8_t *rgba);
+
+/// Copy the given rectangle of pixels from the given sampler's texture to the given buffer.
+///
+/// Each tile overlapping the rectangle is only looked up once, rather than once per pixel.
+/// @param sampler The sampler to copy the pixels from.
+/// @param x The X position of the left edge of the rectangle, in pixels.
+/// @param y The Y position of the top edge of the rectangle, in pixels.
+/// @param width The width of the rectangle, in pixels.
+/// @param height The height of the rectangle, in pixels.
+/// The rectangle must be entirely within the texture.
+/// @param out_rgba The buffer to write the unpacked 8-bit red, green, blue, and alpha channels of the pixels to,
+/// ordered top to bottom with each row left to right.
+/// @param stride The number of bytes between the beginning of each row within the given buffer.
+void ctr_sampler_fetch(struct ctr_sampler_t *sampler,
+                       unsigned int x,
+                       unsigned int y,
+                       unsigned int width,
+                       unsigned int height,
+                       uint8_t *out_rgba,
+                       size_t stride);
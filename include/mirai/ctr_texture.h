@@ -9,6 +9,7 @@
 #pragma once
 
 #include <stdio.h>
+#include <stdatomic.h>
 
 // MARK: - Enumerations
 
@@ -64,6 +65,42 @@ enum ctr_texture_format_t
     CTR_TEXTURE_FORMAT_ETC1_A4  = 0xd,
 };
 
+/// The different formats that decoded CTR texture data can be unpacked to.
+///
+/// Smaller formats can be used to save memory when a texture does not need every channel or the full precision.
+enum ctr_texture_unpack_format_t
+{
+    /// Eight bits for the red, green, blue, and alpha channels.
+    CTR_TEXTURE_UNPACK_FORMAT_RGBA8888 = 0x0,
+
+    /// Five bits for the red and blue channels, and six bits for the green channel, packed into a native endian u16.
+    /// Red is in the highest bits, matching `GL_UNSIGNED_SHORT_5_6_5`.
+    CTR_TEXTURE_UNPACK_FORMAT_RGB565   = 0x1,
+
+    /// Four bits for the red, green, blue, and alpha channels, packed into a native endian u16.
+    /// Red is in the highest bits, matching `GL_UNSIGNED_SHORT_4_4_4_4`.
+    CTR_TEXTURE_UNPACK_FORMAT_RGBA4444 = 0x2,
+
+    /// Eight bits for a single channel.
+    /// This is the alpha channel for alpha only formats, the luminance for luminance formats, and the red channel otherwise.
+    CTR_TEXTURE_UNPACK_FORMAT_R8       = 0x3,
+
+    /// Eight bits for two channels.
+    /// These are the luminance and alpha channels for luminance and alpha formats,
+    /// white and the alpha channel for alpha only formats, and the red and green channels otherwise.
+    CTR_TEXTURE_UNPACK_FORMAT_RG8      = 0x4,
+};
+
+/// The different orders that the colour channels of unpacked CTR texture data can be in.
+enum ctr_texture_channel_order_t
+{
+    /// Red, then green, then blue.
+    CTR_TEXTURE_CHANNEL_ORDER_RGBA = 0x0,
+
+    /// Blue, then green, then red, with the red and blue channels swapped.
+    CTR_TEXTURE_CHANNEL_ORDER_BGRA = 0x1,
+};
+
 // MARK: - Data Structures
 
 /// The data structure for metadata about a CTR texture.
@@ -95,6 +132,39 @@ struct ctr_texture_t
     /// Although this is always a constant `width * height * 4 channels (RGBA)`,
     /// it can be useful for defining fixed length arrays in usage.
     size_t unpacked_data_size;
+
+    /// The total number of mipmap levels within this CTR texture's encoded data, including the full size level.
+    ///
+    /// Levels are stored one after another from the full size level down,
+    /// and each level can be accessed as it's own texture with `ctr_texture_level(texture, level, level_texture)`.
+    /// Note that `decoded_data_size` and `unpacked_data_size` are only of the full size level.
+    unsigned int num_levels;
+
+    /// The hash of this CTR texture's encoded data.
+    ///
+    /// This is computed lazily by `ctr_texture_hash(texture, file)`, and is only valid once `data_hashed` is set.
+    atomic_uint_least64_t data_hash;
+
+    /// Whether or not `data_hash` has been computed yet.
+    atomic_int data_hashed;
+};
+
+/// The data structure for the options of decoding and unpacking a CTR texture in a single pass.
+struct ctr_texture_unpack_options_t
+{
+    /// The format to unpack the texture to.
+    enum ctr_texture_unpack_format_t format;
+
+    /// The order of the colour channels within the unpacked data.
+    ///
+    /// This only applies to formats with both red and blue channels, and is ignored for `R8` and `RG8`.
+    enum ctr_texture_channel_order_t channel_order;
+
+    /// Whether or not to premultiply the colour channels by the alpha channel.
+    int premultiplied;
+
+    /// Whether or not to order the rows bottom to top instead of top to bottom, such as for uploading directly to OpenGL.
+    int flipped;
 };
 
 // MARK: - Functions
@@ -117,12 +187,23 @@ void ctr_texture_create(unsigned int width,
 /// @param texture The CTR texture to read and decode the data of.
 /// @param file The file handle to read the CTR texture's data from.
 /// @returns A pointer to the array of decoded texture data from the given CTR texture.
-/// This data is allocated so it must be freed before program execution completes.
+/// This data is allocated so it must be freed with `allocator_free(pointer)` before program execution completes.
 /// Note that that the decoded data is in different formats for each texture format, see `texture_format_t` cases for more information.
 /// Also note that this data starts from the **upper-left corner**, with each row being left to right.
 /// If this is uploaded directly to OpenGL, then it will be upside down.
 uint8_t *ctr_texture_decode(const struct ctr_texture_t *texture, FILE *file);
 
+/// Get the hash of the given CTR texture's encoded data, reading it from the given file handle if it has not been hashed yet.
+///
+/// The hash is a 64-bit hash of the encoded bytes only, see `utils_hash64(data, size)`,
+/// so textures with equal hashes, formats, and sizes are almost certainly identical, though collisions remain possible.
+/// The result is stored within the given texture, so subsequent calls do not read the file again.
+/// This is thread safe, and holds the file's lock while reading from it.
+/// @param texture The CTR texture to get the hash of.
+/// @param file The file handle to read the CTR texture's data from.
+/// @returns The hash of the given CTR texture's encoded data.
+uint64_t ctr_texture_hash(struct ctr_texture_t *texture, FILE *file);
+
 /// Unpack the given decoded CTR texture data to 8-bit red, green, blue, and alpha channels.
 ///
 /// This is a compatibility feature for directly using OpenGL where luminance and alpha texture data is not supported.
@@ -134,3 +215,142 @@ uint8_t *ctr_texture_decode(const struct ctr_texture_t *texture, FILE *file);
 /// with rows being ordered left to right.
 uint8_t *ctr_texture_unpack(const struct ctr_texture_t *texture,
                             const uint8_t *decoded);
+
+/// Get the size of the given CTR texture's decoded data once unpacked to the given format.
+/// @param texture The CTR texture to get the unpacked size of.
+/// @param format The format that the data is unpacked to.
+/// @returns The size of the unpacked data, in bytes.
+size_t ctr_texture_unpacked_size(const struct ctr_texture_t *texture, enum ctr_texture_unpack_format_t format);
+
+/// Unpack the given decoded CTR texture data to the given format.
+///
+/// Unpacking to `CTR_TEXTURE_UNPACK_FORMAT_RGBA8888` is the same as `ctr_texture_unpack(texture, decoded)`.
+/// Channels are rounded to the nearest value when reduced in precision.
+/// @param texture The CTR texture of which the given decoded data originated from.
+/// @param decoded The decoded CTR texture data to unpack.
+/// @param format The format to unpack the data to.
+/// @returns The unpacked data of the given decoded CTR texture data, of `ctr_texture_unpacked_size(texture, format)` bytes.
+/// Allocated.
+/// This is ordered the same as `ctr_texture_unpack(texture, decoded)`.
+uint8_t *ctr_texture_unpack_format(const struct ctr_texture_t *texture,
+                                   const uint8_t *decoded,
+                                   enum ctr_texture_unpack_format_t format);
+
+/// Read, decode, and unpack the given CTR texture's data from the given file handle in a single pass.
+///
+/// Each pixel is unpacked, converted, and written to it's final position as it is read out of it's tile,
+/// so there are no intermediate buffers of decoded data.
+/// Without any options this produces the same data as `ctr_texture_unpack_format(texture, decoded, format)`.
+/// @param texture The CTR texture to read, decode, and unpack the data of.
+/// @param file The file handle to read the CTR texture's data from.
+/// @param options The options of the unpacked data.
+/// @returns The unpacked data of the given CTR texture, of `ctr_texture_unpacked_size(texture, options->format)` bytes.
+/// Allocated.
+uint8_t *ctr_texture_decode_unpacked(const struct ctr_texture_t *texture,
+                                     FILE *file,
+                                     const struct ctr_texture_unpack_options_t *options);
+
+/// Decode and unpack the given CTR texture from it's encoded data in a single pass.
+///
+/// This is the same as `ctr_texture_decode_unpacked(texture, file, options)`,
+/// but with the encoded data already read, so that the file does not need to be held while decoding.
+/// @param texture The CTR texture to decode and unpack the data of.
+/// @param encoded The encoded data of the entire texture, of `data_size` bytes, as read from it's file.
+/// @param options The options of the unpacked data.
+/// @returns The unpacked data of the given CTR texture, of `ctr_texture_unpacked_size(texture, options->format)` bytes.
+/// Allocated.
+uint8_t *ctr_texture_decode_unpacked_encoded(const struct ctr_texture_t *texture,
+                                             const uint8_t *encoded,
+                                             const struct ctr_texture_unpack_options_t *options);
+
+/// Decode and unpack a single 8x8 tile of the given CTR texture from it's encoded data.
+///
+/// CTR textures are stored as 8x8 pixel tiles, ordered left to right then top to bottom,
+/// so this allows decoding only the parts of a texture that are needed while keeping the rest encoded.
+/// @param texture The CTR texture to decode the tile of.
+/// @param encoded The encoded data of the entire texture, of `data_size` bytes, as read from it's file.
+/// @param tile_x The X position of the tile to decode, in tiles.
+/// @param tile_y The Y position of the tile to decode, in tiles, from the top of the texture.
+/// @param unpacked The 8x8 array to write the tile's unpacked 8-bit red, green, blue, and alpha channels to,
+/// ordered top to bottom with each row left to right.
+void ctr_texture_decode_tile(const struct ctr_texture_t *texture,
+                             const uint8_t *encoded,
+                             unsigned int tile_x,
+                             unsigned int tile_y,
+                             uint8_t *unpacked);
+
+/// Decode a single ETC1 block.
+///
+/// This uses the same decoder as every other CTR texture function,
+/// so differential blocks whose second base colour overflows are decoded as their ETC2 mode.
+/// @param block The 8 bytes of the ETC1 block to decode, in standard big endian order.
+/// @param rgb The 4x4 array to write the block's 8-bit red, green, and blue channels to,
+/// ordered top to bottom with each row left to right.
+void ctr_texture_etc1_block_decode(const uint8_t *block, uint8_t *rgb);
+
+/// Read, decode, and unpack the given CTR texture's data from the given file handle at a reduced size.
+///
+/// Each output pixel is the average of a square of pixels, which is always within a single 8x8 tile,
+/// so each tile is decoded and reduced independently without the full size texture ever existing in memory.
+/// ETC1 and ETC1_A4 textures reduced to a quarter are averaged directly from their compressed blocks, without decoding any pixels.
+/// This is useful for thumbnails and previews.
+/// @param texture The CTR texture to read, decode, and unpack the data of.
+/// @param file The file handle to read the CTR texture's data from.
+/// @param divisor The amount to divide the width and height of the texture by, which must be `2`, `4`, or `8`.
+/// @returns The unpacked 8-bit red, green, blue, and alpha channels of the reduced texture,
+/// of `(width / divisor) * (height / divisor) * 4` bytes.
+/// Allocated.
+/// This is ordered the same as `ctr_texture_unpack(texture, decoded)`, with channels averaged without premultiplication.
+uint8_t *ctr_texture_decode_scaled(const struct ctr_texture_t *texture, FILE *file, unsigned int divisor);
+
+/// Get the size of the encoded data of a CTR texture with the given format and size.
+/// @param data_format The format of the encoded data.
+/// @param width The width of the texture, in pixels.
+/// @param height The height of the texture, in pixels.
+/// @returns The size of the encoded data, in bytes.
+size_t ctr_texture_encoded_size(enum ctr_texture_format_t data_format, unsigned int width, unsigned int height);
+
+/// Get the given mipmap level of the given CTR texture as it's own texture.
+///
+/// Each level is half the size of the previous, down to a minimum of 8x8 pixels.
+/// The level texture has a single level, and can be used with every other CTR texture function.
+/// @param texture The CTR texture to get the level of.
+/// @param level The index of the level to get, where `0` is the full size level.
+/// This must be less than `num_levels`.
+/// @param level_texture The CTR texture data structure to fill in with the level.
+void ctr_texture_level(const struct ctr_texture_t *texture, unsigned int level, struct ctr_texture_t *level_texture);
+
+/// Read and decode every mipmap level of the given CTR texture's data from the given file handle.
+///
+/// See `ctr_texture_decode(texture, file)` for the format of each level.
+/// @param texture The CTR texture to read and decode the levels of.
+/// @param file The file handle to read the CTR texture's data from.
+/// @returns An array of the decoded data of each level, of `num_levels` items, from the full size level down.
+/// The array and each item are allocated.
+uint8_t **ctr_texture_decode_levels(const struct ctr_texture_t *texture, FILE *file);
+
+/// Read, decode, and unpack the given CTR texture's data from the given file handle one row of tiles at a time,
+/// passing each row of tiles to the given callback as it is decoded.
+///
+/// Only a single row of tiles is ever held in memory, of both encoded and unpacked data,
+/// so the peak memory usage is proportional to `width * 8` rather than the size of the texture.
+/// This is useful for writing large textures straight to another file or uploading them in parts.
+/// @param texture The CTR texture to read, decode, and unpack the data of.
+/// @param file The file handle to read the CTR texture's data from.
+/// @param options The options of the unpacked data.
+/// If the rows are flipped, then they are passed bottom row of tiles first, so that the rows are still passed in output order.
+/// @param callback The function to call with each row of tiles, in output order.
+/// `rows` is the unpacked data of the rows, which is only valid for the duration of the call.
+/// `first_row` is the index of the first row within the full unpacked output, and `num_rows` is always `8`.
+/// `stride` is the number of bytes between the beginning of each row.
+/// `context` is the given context.
+/// @param context The context to pass to the given callback.
+void ctr_texture_decode_rows(const struct ctr_texture_t *texture,
+                             FILE *file,
+                             const struct ctr_texture_unpack_options_t *options,
+                             void (*callback)(const uint8_t *rows,
+                                              unsigned int first_row,
+                                              unsigned int num_rows,
+                                              size_t stride,
+                                              void *context),
+                             void *context);
@@ -0,0 +1,45 @@
+//
+//  ctr_transcode.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "ctr_texture.h"
+
+// MARK: - Functions
+
+/// Transcode the given ETC1 block to a BC1 block.
+///
+/// The block is decoded, then the BC1 endpoints are taken from the pixels furthest apart along it's principal axis,
+/// and each pixel is assigned the nearest colour along the line between them.
+/// There is no iterative search, so this is fast enough for load time but not quite as accurate as a full encode.
+/// @param etc1 The 8 bytes of the ETC1 block to transcode, in standard big endian order.
+/// @param bc1 The 8 bytes to write the BC1 block to.
+void ctr_transcode_etc1_to_bc1(const uint8_t *etc1, uint8_t *bc1);
+
+/// Transcode the given 4x4 block of alpha values to a BC4 block, the same as the alpha block of BC3.
+///
+/// The BC4 endpoints are the highest and lowest alpha values, with each value assigned the nearest of the eight levels between them.
+/// @param alpha The 16 8-bit alpha values of the block, ordered top to bottom with each row left to right.
+/// @param bc4 The 8 bytes to write the BC4 block to.
+void ctr_transcode_alpha_to_bc4(const uint8_t *alpha, uint8_t *bc4);
+
+/// Read the given ETC1 or ETC1_A4 CTR texture and transcode it to BC1 or BC3 respectively, without decoding it to pixels first.
+///
+/// ETC1 textures transcode to BC1, which is the same size as ETC1.
+/// ETC1_A4 textures transcode to BC3, with the colour from the ETC1 blocks and the alpha from the four bit alpha.
+/// Like `ctr_texture_decode(texture, file)`, the first row of blocks is the top of the texture.
+/// @param texture The CTR texture to transcode, which must be either `CTR_TEXTURE_FORMAT_ETC1` or `CTR_TEXTURE_FORMAT_ETC1_A4`.
+/// @param file The file handle to read the CTR texture's data from.
+/// @param size The size of the transcoded data, in bytes.
+/// This is `width * height / 2` for BC1, and `width * height` for BC3.
+/// @returns The transcoded blocks of the given CTR texture, ordered left to right, then top to bottom.
+/// Allocated.
+uint8_t *ctr_transcode_read_bc(const struct ctr_texture_t *texture, FILE *file, size_t *size);
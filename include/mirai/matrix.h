@@ -0,0 +1,40 @@
+//
+//  matrix.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+
+// MARK: - Data Structures
+
+/// A data structure to represent a two dimensional affine transformation matrix.
+///
+/// Points are transformed as `x' = (a * x) + (c * y) + tx` and `y' = (b * x) + (d * y) + ty`.
+struct matrix2d_t
+{
+    float a, b, c, d, tx, ty;
+};
+
+// MARK: - Functions
+
+/// Get the identity matrix, which transforms points to themselves.
+/// @returns The identity matrix.
+struct matrix2d_t matrix2d_identity(void);
+
+/// Multiply the two given matrices.
+/// @param a The left hand matrix, applied last.
+/// @param b The right hand matrix, applied first.
+/// @returns The product of the two given matrices.
+struct matrix2d_t matrix2d_multiply(struct matrix2d_t a, struct matrix2d_t b);
+
+/// Invert the given matrix.
+/// @param matrix The matrix to invert.
+/// @param inverse The matrix to write the inverse of the given matrix to.
+/// @returns Whether or not the given matrix could be inverted.
+/// If the given matrix is degenerate, such as from a zero scale, then this is `0` and the inverse is not written.
+int matrix2d_invert(struct matrix2d_t matrix, struct matrix2d_t *inverse);
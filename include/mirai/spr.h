@@ -101,6 +101,20 @@ struct scr_t
 /// @param spr The SPR to open the file into.
 void spr_open(const char *path, struct spr_t *spr);
 
+/// Open the SPR file at the given path into the given SPR, keeping only the SCRs of the given names.
+///
+/// Only the textures used by the kept SCRs are read, and all other CTPKs are skipped without being parsed.
+/// The SPR is compacted to contain only what is kept, so texture indices are not the same as in the file,
+/// although the kept SCRs and textures remain in the same order.
+/// SCR names which are not within the file are ignored.
+///
+/// To open only what a composition references, pass it's `num_scr_names` and `scr_names`.
+/// @param path The path of the SPR file to open.
+/// @param num_scr_names The total number of SCR names within the given array.
+/// @param scr_names The names of the SCRs to keep.
+/// @param spr The SPR to open the file into.
+void spr_open_referenced(const char *path, unsigned int num_scr_names, char *const *scr_names, struct spr_t *spr);
+
 /// Close the given SPR, releasing all of it's allocated memory.
 ///
 /// This must be called after an SPR is opened and before program execution completes.
@@ -0,0 +1,170 @@
+//
+//  texture_cache.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "ctr_texture.h"
+#include "allocator.h"
+
+// MARK: - Enumerations
+
+/// The different forms that a texture cache can hold a texture's data in.
+enum texture_cache_output_t
+{
+    /// The data as returned by `ctr_texture_decode(texture, file)`.
+    TEXTURE_CACHE_OUTPUT_DECODED  = 0x0,
+
+    /// The data as returned by `ctr_texture_unpack(texture, decoded)`.
+    TEXTURE_CACHE_OUTPUT_UNPACKED = 0x1,
+};
+
+// MARK: - Data Structures
+
+/// The data structure for the properties identifying a single texture within a texture cache.
+struct texture_cache_key_t
+{
+    /// The identity of the source that the texture is read from, such as the SPR containing it.
+    ///
+    /// This is only compared, never dereferenced.
+    const void *source;
+
+    /// The offset of the texture's encoded data within it's file, in bytes.
+    size_t data_pointer;
+
+    /// The format of the texture's encoded data.
+    enum ctr_texture_format_t data_format;
+
+    /// The form that the texture's data is held in.
+    enum texture_cache_output_t output;
+};
+
+/// The data structure for a single texture held within a texture cache.
+struct texture_cache_entry_t
+{
+    /// The properties identifying this entry's texture.
+    struct texture_cache_key_t key;
+
+    /// The data of this entry's texture, in the form of the key's output.
+    ///
+    /// Only valid while this entry is pinned.
+    /// Allocated.
+    uint8_t *data;
+
+    /// The size of `data`, in bytes.
+    size_t size;
+
+    /// The number of handles currently pinning this entry.
+    ///
+    /// Pinned entries are never evicted.
+    unsigned int pins;
+
+    /// Whether or not `data` has been decoded yet.
+    int ready;
+
+    /// The index of the shard containing this entry, within the cache's shards.
+    unsigned int shard_index;
+
+    /// The next entry within the same hash bucket, if any.
+    struct texture_cache_entry_t *bucket_next;
+
+    /// The more recently used entry within the same shard, if any.
+    struct texture_cache_entry_t *newer;
+
+    /// The less recently used entry within the same shard, if any.
+    struct texture_cache_entry_t *older;
+};
+
+/// The data structure for a subset of the entries of a texture cache, guarded by it's own lock.
+struct texture_cache_shard_t
+{
+    /// The mutex guarding every field of this shard and it's entries.
+    pthread_mutex_t mutex;
+
+    /// The condition signalled whenever an entry within this shard finishes decoding.
+    pthread_cond_t decoded;
+
+    /// The first entry of each hash bucket within this shard, if any.
+    ///
+    /// Allocated.
+    struct texture_cache_entry_t **buckets;
+
+    /// The most recently used entry within this shard, if any.
+    struct texture_cache_entry_t *newest;
+
+    /// The least recently used entry within this shard, if any.
+    struct texture_cache_entry_t *oldest;
+};
+
+/// The data structure for a thread-safe cache of decoded textures, limited to a budget of memory.
+///
+/// Entries are spread across shards by their key, so threads acquiring different textures rarely contend.
+/// When the budget is exceeded, the least recently used unpinned entries are evicted, one shard at a time.
+/// Concurrent acquisitions of the same texture are coalesced into a single decode.
+struct texture_cache_t
+{
+    /// The number of bytes of texture data that this cache keeps at most, while no entries are pinned.
+    size_t budget;
+
+    /// The number of bytes of texture data currently within this cache.
+    atomic_size_t size;
+
+    /// The shard to begin evicting from next, so that eviction is spread evenly across shards.
+    atomic_uint eviction_shard;
+
+    /// All the shards of this cache.
+    ///
+    /// Allocated.
+    struct texture_cache_shard_t *shards;
+
+    /// The allocator of the thread that created this cache.
+    ///
+    /// Entries are allocated and freed with this allocator, as they may be evicted by a different thread than decoded them.
+    const struct allocator_t *allocator;
+};
+
+// MARK: - Functions
+
+/// Create a texture cache with the given budget.
+/// @param budget The number of bytes of texture data to keep at most.
+/// Pinned entries are kept regardless, so the budget can be exceeded while they are in use.
+/// @param cache The texture cache to create.
+void texture_cache_create(size_t budget, struct texture_cache_t *cache);
+
+/// Destroy the given texture cache, releasing all of it's allocated memory.
+///
+/// Every entry must have been released first.
+/// @param cache The texture cache to destroy.
+void texture_cache_destroy(struct texture_cache_t *cache);
+
+/// Get the given texture from the given texture cache, decoding it if it is not already cached.
+///
+/// If another thread is already decoding the same texture, then this waits for it to finish instead of decoding it again.
+/// The file is locked with `flockfile` while decoding, so textures from the same file can be acquired from multiple threads.
+/// @param cache The texture cache to get the texture from.
+/// @param source The identity of the source that the given texture is read from, such as the SPR containing it.
+/// This must be unique to the given file for as long as the cache holds any of it's textures.
+/// @param file The file handle to read the given texture's data from, if it needs to be decoded.
+/// @param texture The texture to get.
+/// @param output The form to get the texture's data in.
+/// @returns The pinned entry of the given texture, with it's data.
+/// The entry is not evicted until it is released with `texture_cache_release(cache, entry)`.
+struct texture_cache_entry_t *texture_cache_acquire(struct texture_cache_t *cache,
+                                                   const void *source,
+                                                   FILE *file,
+                                                   const struct ctr_texture_t *texture,
+                                                   enum texture_cache_output_t output);
+
+/// Release the given entry of the given texture cache, unpinning it so that it may be evicted.
+/// @param cache The texture cache containing the given entry.
+/// @param entry The entry to release, as returned by `texture_cache_acquire(cache, source, file, texture, output)`.
+void texture_cache_release(struct texture_cache_t *cache, struct texture_cache_entry_t *entry);
@@ -0,0 +1,82 @@
+//
+//  texture_disk_cache.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+
+#include "ctr_texture.h"
+
+// MARK: - Data Structures
+
+/// The data structure for a directory of unpacked textures persisted across runs.
+///
+/// Each texture is stored within it's own file, named by a hash of it's encoded data along with it's format and size,
+/// so identical textures from different files share a single entry.
+/// The unpacked data within each file begins on a page boundary, so that it can be mapped into memory and used directly.
+/// Entries are written to a temporary file and then renamed into place,
+/// so multiple processes can safely share the same directory.
+struct texture_disk_cache_t
+{
+    /// The path of the directory containing this cache's files.
+    ///
+    /// Allocated.
+    char *directory;
+};
+
+/// The data structure for the unpacked data of a single texture from a disk cache.
+struct texture_disk_cache_entry_t
+{
+    /// The unpacked 8-bit red, green, blue, and alpha data of this entry's texture.
+    const uint8_t *data;
+
+    /// The size of `data`, in bytes.
+    size_t size;
+
+    /// The memory mapping of this entry's file, if it is mapped.
+    ///
+    /// If the texture could not be written to the cache, then this is `NULL` and `data` is allocated instead.
+    void *mapping;
+
+    /// The size of `mapping`, in bytes.
+    size_t mapping_size;
+};
+
+// MARK: - Functions
+
+/// Open the disk cache within the directory at the given path, creating the directory if it does not exist.
+/// @param directory The path of the directory to store the cache's files within.
+/// @param cache The disk cache to open the directory into.
+void texture_disk_cache_open(const char *directory, struct texture_disk_cache_t *cache);
+
+/// Close the given disk cache, releasing all of it's allocated memory.
+///
+/// The files within the cache's directory are kept for later runs.
+/// @param cache The disk cache to close.
+void texture_disk_cache_close(struct texture_disk_cache_t *cache);
+
+/// Get the unpacked data of the given texture from the given disk cache.
+///
+/// If the texture is already within the cache, then it's file is mapped and used without decoding.
+/// Otherwise the texture is decoded, unpacked, and written to the cache before being mapped.
+/// Files from older versions of the cache, or which do not match the texture, are replaced.
+/// @param cache The disk cache to get the texture from.
+/// @param texture The texture to get.
+/// It's hash is computed with `ctr_texture_hash(texture, file)` if it has not been already.
+/// @param file The file handle to read the given texture's data from.
+/// @param entry The entry to write the texture's unpacked data to.
+/// It must be released with `texture_disk_cache_entry_release(entry)` once it is no longer needed.
+void texture_disk_cache_get(struct texture_disk_cache_t *cache,
+                            struct ctr_texture_t *texture,
+                            FILE *file,
+                            struct texture_disk_cache_entry_t *entry);
+
+/// Release the given disk cache entry, unmapping or freeing it's data.
+/// @param entry The entry to release.
+void texture_disk_cache_entry_release(struct texture_disk_cache_entry_t *entry);
@@ -0,0 +1,123 @@
+//
+//  texture_registry.h
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#pragma once
+
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "ctr_texture.h"
+#include "allocator.h"
+
+// MARK: - Data Structures
+
+/// The data structure for a single unique texture held within a texture registry.
+struct texture_registry_entry_t
+{
+    /// The hash of this entry's texture's encoded data, see `ctr_texture_hash(texture, file)`.
+    uint64_t hash;
+
+    /// The format of this entry's texture's encoded data.
+    enum ctr_texture_format_t data_format;
+
+    /// The width of this entry's texture, in pixels.
+    unsigned int width;
+
+    /// The height of this entry's texture, in pixels.
+    unsigned int height;
+
+    /// The encoded data of this entry's texture, compared against textures with the same hash before they share this entry.
+    ///
+    /// Allocated.
+    uint8_t *encoded;
+
+    /// The size of `encoded`, in bytes.
+    size_t encoded_size;
+
+    /// The unpacked 8-bit red, green, blue, and alpha data of this entry's texture.
+    ///
+    /// Only valid while this entry is referenced.
+    /// Allocated.
+    uint8_t *data;
+
+    /// The size of `data`, in bytes.
+    size_t size;
+
+    /// The number of acquisitions currently referencing this entry.
+    unsigned int references;
+
+    /// Whether or not `data` has been decoded yet.
+    int ready;
+
+    /// The next entry within the same hash bucket, if any.
+    struct texture_registry_entry_t *bucket_next;
+};
+
+/// The data structure for a thread-safe registry of textures, deduplicated by their contents.
+///
+/// Textures with identical encoded data, formats, and sizes share a single entry,
+/// so a texture that is duplicated across many SPRs is only decoded and kept in memory once.
+/// Entries are kept for as long as any acquisition references them.
+struct texture_registry_t
+{
+    /// The mutex guarding every field of this registry and it's entries.
+    pthread_mutex_t mutex;
+
+    /// The condition signalled whenever an entry within this registry finishes decoding.
+    pthread_cond_t decoded;
+
+    /// The first entry of each hash bucket within this registry, if any.
+    ///
+    /// Allocated.
+    struct texture_registry_entry_t **buckets;
+
+    /// The total number of unique textures currently within this registry.
+    unsigned int num_entries;
+
+    /// The number of bytes of texture data currently within this registry.
+    size_t size;
+
+    /// The allocator of the thread that created this registry.
+    ///
+    /// Entries are allocated and freed with this allocator, as the last reference may be released by any thread.
+    const struct allocator_t *allocator;
+};
+
+// MARK: - Functions
+
+/// Create an empty texture registry.
+/// @param registry The texture registry to create.
+void texture_registry_create(struct texture_registry_t *registry);
+
+/// Destroy the given texture registry, releasing all of it's allocated memory.
+///
+/// Every entry must have been released first.
+/// @param registry The texture registry to destroy.
+void texture_registry_destroy(struct texture_registry_t *registry);
+
+/// Get the entry for the given texture's contents from the given registry, decoding it if no identical texture is registered.
+///
+/// The given texture is hashed first if it has not been already, and it's encoded data is then read.
+/// Textures are only shared when their hashes, formats, sizes, and encoded data are all equal,
+/// so a hash collision costs a comparison rather than returning the wrong texture.
+/// If another thread is already decoding an identical texture, then this waits for it to finish instead of decoding it again.
+/// The file is locked with `flockfile` while reading, so textures from the same file can be acquired from multiple threads.
+/// @param registry The texture registry to get the texture from.
+/// @param texture The texture to get, which is updated with it's hash.
+/// @param file The file handle to read the given texture's data from.
+/// @returns The referenced entry of the given texture's contents, with it's unpacked data.
+/// The entry is kept until it is released with `texture_registry_release(registry, entry)`.
+struct texture_registry_entry_t *texture_registry_acquire(struct texture_registry_t *registry,
+                                                         struct ctr_texture_t *texture,
+                                                         FILE *file);
+
+/// Release the given entry of the given texture registry, freeing it once it is no longer referenced.
+/// @param registry The texture registry containing the given entry.
+/// @param entry The entry to release, as returned by `texture_registry_acquire(registry, texture, file)`.
+void texture_registry_release(struct texture_registry_t *registry, struct texture_registry_entry_t *entry);
@@ -23,5 +23,54 @@ uint32_t utils_read_relative_pointer(FILE *file);
 /// Read the null terminated string at the current offset of the given file handle.
 /// @param file The file handle to read the string from.
 /// @returns The null terminated string at the current offset of the given file handle.
-/// This string is allocated and must be freed.
+/// This string is allocated and must be freed with `allocator_free(pointer)`.
 char *utils_read_string(FILE *file);
+
+/// Read the file's bytes from the given offset into the given buffer in a single read.
+///
+/// This is used to read entire arrays of fixed size records at once, which are then decoded from memory,
+/// rather than reading each field of each record from the file individually.
+/// If the file ends before the given size, then the rest of the buffer is zeroed.
+/// @param file The file handle to read from.
+/// @param pointer The offset within the given file to read from, in bytes.
+/// @param size The number of bytes to read.
+/// @param buffer The buffer to read into, of at least the given size.
+void utils_read_block(FILE *file, long pointer, size_t size, void *buffer);
+
+/// Load the little endian u16 at the given address.
+/// @param data The address of the u16 to load. This does not need to be aligned.
+/// @returns The u16 at the given address.
+uint16_t utils_load_u16(const uint8_t *data);
+
+/// Load the little endian u32 at the given address.
+/// @param data The address of the u32 to load. This does not need to be aligned.
+/// @returns The u32 at the given address.
+uint32_t utils_load_u32(const uint8_t *data);
+
+/// Load the little endian 32-bit float at the given address.
+/// @param data The address of the float to load. This does not need to be aligned.
+/// @returns The float at the given address.
+float utils_load_f32(const uint8_t *data);
+
+/// Get whether or not all the bytes at the given address are zero, such as for padding.
+/// @param data The address of the bytes to check.
+/// @param size The number of bytes to check.
+/// @returns Whether or not all the given bytes are zero.
+int utils_is_zero(const uint8_t *data, size_t size);
+
+/// Get the 64-bit hash of the given data.
+///
+/// This is XXH64 with a seed of zero, so it is fast enough to hash entire textures,
+/// and it's output matches other implementations of XXH64.
+/// @param data The data to hash.
+/// @param size The size of the given data, in bytes.
+/// @returns The 64-bit hash of the given data.
+uint64_t utils_hash64(const void *data, size_t size);
+
+/// Get the CRC32 of the given data.
+///
+/// This is the standard reflected CRC32, the same as zlib's `crc32`.
+/// @param data The data to get the CRC32 of.
+/// @param size The size of the given data, in bytes.
+/// @returns The CRC32 of the given data.
+uint32_t utils_crc32(const void *data, size_t size);
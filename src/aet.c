@@ -12,57 +12,63 @@
 #include <string.h>
 #include <assert.h>
 
+#include "allocator.h"
 #include "utils.h"
 
+// MARK: - Constants
+
+/// The size of each sprite within an AET, in bytes.
+const size_t aet_sprite_size = 20;
+
+/// The size of each sprite group within an AET, in bytes.
+const size_t aet_sprite_group_size = 20;
+
+/// The size of each layer within an AET, in bytes.
+const size_t aet_layer_size = 48;
+
 // MARK: - Functions
 
-/// Read the sprite at the current position of the given file into the given sprite.
-/// @param file The file to read the sprite from.
-/// @param sprite The sprite to read the file into.
-void aet_sprite_read(FILE *file, struct aet_sprite_t *sprite)
+/// Decode the given sprite into the given sprite.
+/// @param data The sprite to decode, of `aet_sprite_size` bytes.
+/// @param sprite The sprite to decode the data into.
+void aet_sprite_decode(const uint8_t *data, struct aet_sprite_t *sprite)
 {
-    // read the scr index
-    uint32_t scr_index;
-    fread(&scr_index, sizeof(scr_index), 1, file);
+    // scr index
+    uint32_t scr_index = utils_load_u32(data);
 
     // padding
-    for (int i = 0; i < 8; i++)
-        assert(fgetc(file) == 0x0);
+    assert(utils_is_zero(data + 4, 8));
 
     // 2x float unknown
-    fseek(file, 2 * 4, SEEK_CUR);
 
     // initialize the sprite
     sprite->scr_index = scr_index;
 }
 
-/// Read the sprite group at the current position of the given file into the given sprite group.
-/// @param file The file to read the sprite group from.
-/// @param sprite_group The sprite group to read the file into.
-void aet_sprite_group_read(FILE *file, struct aet_sprite_group_t *sprite_group)
+/// Decode the given sprite group into the given sprite group, reading it's sprites from the given file.
+/// @param file The file to read the sprite group's sprites from.
+/// @param data The sprite group to decode, of `aet_sprite_group_size` bytes.
+/// @param sprite_group The sprite group to decode the data into.
+void aet_sprite_group_read(FILE *file, const uint8_t *data, struct aet_sprite_group_t *sprite_group)
 {
-    // read the multiply colour
+    // multiply colour
     // only the rgb channels are available, so force full opacity
-    uint8_t multiply_r, multiply_g, multiply_b;
-    fread(&multiply_r, sizeof(multiply_r), 1, file);
-    fread(&multiply_g, sizeof(multiply_g), 1, file);
-    fread(&multiply_b, sizeof(multiply_b), 1, file);
+    uint8_t multiply_r = data[0];
+    uint8_t multiply_g = data[1];
+    uint8_t multiply_b = data[2];
 
     // padding
-    assert(fgetc(file) == 0x0);
+    assert(data[3] == 0x0);
 
-    // read the size
-    uint16_t width, height;
-    fread(&width, sizeof(width), 1, file);
-    fread(&height, sizeof(height), 1, file);
+    // size
+    uint16_t width = utils_load_u16(data + 4);
+    uint16_t height = utils_load_u16(data + 6);
 
     // 1x float unknown
-    fseek(file, 4, SEEK_CUR);
 
-    // read the sprite count and pointer
-    uint32_t num_sprites, sprites_pointer;
-    fread(&num_sprites, sizeof(num_sprites), 1, file);
-    fread(&sprites_pointer, sizeof(sprites_pointer), 1, file);
+    // sprite count and pointer
+    uint32_t num_sprites = utils_load_u32(data + 12);
+    uint32_t sprites_pointer = utils_load_u32(data + 16);
 
     // initialize the sprite group
     sprite_group->multiply_color.r = (float)multiply_r / (float)UINT8_MAX;
@@ -72,23 +78,83 @@ void aet_sprite_group_read(FILE *file, struct aet_sprite_group_t *sprite_group)
     sprite_group->width = width;
     sprite_group->height = height;
 
-    // read the sprites
+    // read all the sprites at once
+    uint8_t *sprites = allocator_malloc(num_sprites * aet_sprite_size);
+    utils_read_block(file, sprites_pointer, num_sprites * aet_sprite_size, sprites);
+
+    // decode the sprites
     sprite_group->num_sprites = num_sprites;
-    sprite_group->sprites = malloc(num_sprites * sizeof(struct aet_sprite_t));
+    sprite_group->sprites = allocator_malloc(num_sprites * sizeof(struct aet_sprite_t));
     for (int i = 0; i < num_sprites; i++)
+        aet_sprite_decode(sprites + (i * aet_sprite_size), &sprite_group->sprites[i]);
+
+    allocator_free(sprites);
+}
+
+/// Classify the given marker by it's name, setting it's type, name hash, and value.
+///
+/// Names are split into a prefix and a trailing numeric value, such as `BPM` and `205` for `BPM205`,
+/// and the prefix is then matched against the known names by hash, so only a single comparison is made.
+/// @param marker The marker to classify. It's name must already be set.
+void aet_marker_classify(struct aet_marker_t *marker)
+{
+    const char *name = marker->name;
+    size_t length = strlen(name);
+
+    // split off the trailing numeric value, if any
+    size_t prefix_length = length;
+    int has_digit = 0;
+    while (prefix_length > 0)
     {
-        // array
-        fseek(file, sprites_pointer + (i * 20), SEEK_SET);
+        char c = name[prefix_length - 1];
+        if (c >= '0' && c <= '9')
+            has_digit = 1;
+        else if (c != '.')
+            break;
 
-        // insert the sprite
-        struct aet_sprite_t sprite;
-        aet_sprite_read(file, &sprite);
-        sprite_group->sprites[i] = sprite;
+        prefix_length--;
     }
+
+    if (!has_digit)
+        prefix_length = length;
+
+    marker->name_hash = aet_marker_name_hash(name, prefix_length);
+    marker->has_value = has_digit;
+    marker->value = has_digit ? strtof(name + prefix_length, NULL) : 0;
+
+    // match the prefix against the known names
+    // these are the fnv-1a hashes of each name, see aet_marker_name_hash
+    enum aet_marker_type_t type = AET_MARKER_TYPE_UNKNOWN;
+    const char *known_name = NULL;
+    switch (marker->name_hash)
+    {
+        case 0x1537b96c: known_name = "ST_IN";  type = AET_MARKER_TYPE_IN_START;    break;
+        case 0x3d3fba2a: known_name = "ED_IN";  type = AET_MARKER_TYPE_IN_END;      break;
+        case 0x192f70f3: known_name = "ST_LP";  type = AET_MARKER_TYPE_LOOP_START;  break;
+        case 0x5d4b257d: known_name = "ED_LP";  type = AET_MARKER_TYPE_LOOP_END;    break;
+        case 0xc7449279: known_name = "ST_OUT"; type = AET_MARKER_TYPE_OUT_START;   break;
+        case 0x247bfdc3: known_name = "ED_OUT"; type = AET_MARKER_TYPE_OUT_END;     break;
+        case 0xef468824: known_name = "ST_SP";  type = AET_MARKER_TYPE_PRESS_START; break;
+        case 0x1b802bfa: known_name = "ED_SP";  type = AET_MARKER_TYPE_PRESS_END;   break;
+        case 0xa2975326: known_name = "BPM";    type = AET_MARKER_TYPE_BPM;         break;
+        default: break;
+    }
+
+    // guard against hash collisions, and only tempo markers take a value
+    if (known_name == NULL ||
+        strncmp(name, known_name, prefix_length) != 0 ||
+        known_name[prefix_length] != '\0' ||
+        has_digit != (type == AET_MARKER_TYPE_BPM))
+    {
+        type = AET_MARKER_TYPE_UNKNOWN;
+    }
+
+    marker->type = type;
 }
 
-/// Read the layer at the current position of the given file into the given layer.
-/// @param file The file to read the layer from.
+/// Decode the given layer into the given layer, reading the rest of it's data from the given file.
+/// @param file The file to read the layer's name, source, markers, and properties from.
+/// @param data The layer to decode, of `aet_layer_size` bytes.
 /// @param num_related_layers The total number of layers within the given array.
 /// @param related_layers All the possibly related layers that this layer can point to for children and parents.
 /// It is asserted that the children and/or parent for this layer are within this array.
@@ -102,8 +168,9 @@ void aet_sprite_group_read(FILE *file, struct aet_sprite_group_t *sprite_group)
 /// It is expected that this array is kept in memory until the layer is released.
 /// @param sprite_group_pointers The pointer to each sprite group within the given array,
 /// within the given file handle.
-/// @param layer The layer to read the file into.
+/// @param layer The layer to decode the data into.
 void aet_layer_read(FILE *file,
+                    const uint8_t *data,
                     unsigned int num_related_layers,
                     struct aet_layer_t *related_layers,
                     const size_t *related_layer_pointers,
@@ -112,52 +179,38 @@ void aet_layer_read(FILE *file,
                     const size_t *sprite_group_pointers,
                     struct aet_layer_t *layer)
 {
-    // read the name and seek back
-    uint32_t name_pointer;
-    fread(&name_pointer, sizeof(name_pointer), 1, file);
-    long name_return = ftell(file);
+    // name
+    uint32_t name_pointer = utils_load_u32(data);
     fseek(file, name_pointer, SEEK_SET);
     char *name = utils_read_string(file);
-    fseek(file, name_return, SEEK_SET);
 
-    // read the timeline properties
+    // timeline properties
     // third float is unknown, skip it
-    float timeline_start_frame, timeline_end_frame, timeline_speed;
-    fread(&timeline_start_frame, sizeof(timeline_start_frame), 1, file);
-    fread(&timeline_end_frame, sizeof(timeline_end_frame), 1, file);
-    fseek(file, 4, SEEK_CUR);
-    fread(&timeline_speed, sizeof(timeline_speed), 1, file);
+    float timeline_start_frame = utils_load_f32(data + 4);
+    float timeline_end_frame = utils_load_f32(data + 8);
+    float timeline_speed = utils_load_f32(data + 16);
 
     // unknown values
     //  - 1x u16 flags unknown
     //  - 1x u8 unknown
-    fseek(file, 2 + 1, SEEK_CUR);
-
-    // read the type and source pointer
-    // init 0x0 and fread sizeof(u8) as sizeof(enum) is 4
-    enum aet_layer_type_t type = 0x0;
-    fread(&type, sizeof(uint8_t), 1, file);
 
-    uint32_t source_pointer;
-    fread(&source_pointer, sizeof(source_pointer), 1, file);
+    // type and source pointer
+    enum aet_layer_type_t type = data[23];
+    uint32_t source_pointer = utils_load_u32(data + 24);
 
     // u32 parent layer pointer, unused
     // the parent is set later on when children are read
     // as the parent is not always read before this point
-    fseek(file, 4, SEEK_CUR);
 
-    // read the marker count and pointer
-    uint32_t num_markers, markers_pointer;
-    fread(&num_markers, sizeof(num_markers), 1, file);
-    fread(&markers_pointer, sizeof(markers_pointer), 1, file);
+    // marker count and pointer
+    uint32_t num_markers = utils_load_u32(data + 32);
+    uint32_t markers_pointer = utils_load_u32(data + 36);
 
-    // read the properties pointer
-    uint32_t properties_pointer;
-    fread(&properties_pointer, sizeof(properties_pointer), 1, file);
+    // properties pointer
+    uint32_t properties_pointer = utils_load_u32(data + 40);
 
     // padding
-    for (int i = 0; i < 4; i++)
-        assert(fgetc(file) == 0x0);
+    assert(utils_is_zero(data + 44, 4));
 
     // initialize the layer
     layer->name = name;
@@ -203,7 +256,7 @@ void aet_layer_read(FILE *file,
             // get and set the children
             layer->sprite_group = NULL;
             layer->num_children = num_children;
-            layer->children = calloc(num_children, sizeof(struct aet_layer_t));
+            layer->children = allocator_calloc(num_children, sizeof(struct aet_layer_t));
             for (int c = 0; c < num_children; c++)
             {
                 // array
@@ -230,7 +283,7 @@ void aet_layer_read(FILE *file,
 
     // read the markers
     layer->num_markers = num_markers;
-    layer->markers = malloc(num_markers * sizeof(struct aet_marker_t));
+    layer->markers = allocator_malloc(num_markers * sizeof(struct aet_marker_t));
     for (int i = 0; i < num_markers; i++)
     {
         // array
@@ -246,30 +299,11 @@ void aet_layer_read(FILE *file,
         fseek(file, name_pointer, SEEK_SET);
         char *name = utils_read_string(file);
 
-        // attempt to read the type
-        enum aet_marker_type_t type = AET_MARKER_TYPE_UNKNOWN;
-        if (strcmp(name, "ST_IN") == 0)
-            type = AET_MARKER_TYPE_IN_START;
-        else if (strcmp(name, "ED_IN") == 0)
-            type = AET_MARKER_TYPE_IN_END;
-        else if (strcmp(name, "ST_LP") == 0)
-            type = AET_MARKER_TYPE_LOOP_START;
-        else if (strcmp(name, "ED_LP") == 0)
-            type = AET_MARKER_TYPE_LOOP_END;
-        else if (strcmp(name, "ST_OUT") == 0)
-            type = AET_MARKER_TYPE_OUT_START;
-        else if (strcmp(name, "ED_OUT") == 0)
-            type = AET_MARKER_TYPE_OUT_END;
-        else if (strcmp(name, "ST_SP") == 0)
-            type = AET_MARKER_TYPE_PRESS_START;
-        else if (strcmp(name, "ED_SP") == 0)
-            type = AET_MARKER_TYPE_PRESS_END;
-
         // insert the marker
         struct aet_marker_t *marker = &layer->markers[i];
         marker->frame = frame;
         marker->name = name;
-        marker->type = type;
+        aet_marker_classify(marker);
     }
 
     // read the properties
@@ -298,7 +332,7 @@ void aet_layer_read(FILE *file,
 
         struct aet_layer_keyframes_t keyframes;
         keyframes.num_keyframes = num_keyframes;
-        keyframes.values = malloc(num_keyframes * sizeof(float));
+        keyframes.values = allocator_malloc(num_keyframes * sizeof(float));
         if (num_keyframes == 1)
         {
             keyframes.type = AET_LAYER_KEYFRAMES_TYPE_SINGLE;
@@ -314,7 +348,7 @@ void aet_layer_read(FILE *file,
         else
         {
             keyframes.type = AET_LAYER_KEYFRAMES_TYPE_MULTIPLE;
-            keyframes.frames = malloc(num_keyframes * sizeof(float));
+            keyframes.frames = allocator_malloc(num_keyframes * sizeof(float));
 
             // read and insert all the keyframes
             for (int i = 0; i < num_keyframes; i++)
@@ -371,8 +405,11 @@ void aet_open(const char *path, struct aet_t *aet)
     fread(&composition_scr_names_pointer, sizeof(composition_scr_names_pointer), 1, file);
 
     // padding
-    for (int i = 0; i < header_size - 16; i++)
-        assert(fgetc(file) == 0x0);
+    assert(header_size >= 16);
+    uint8_t *header_padding = allocator_malloc(header_size - 16);
+    utils_read_block(file, ftell(file), header_size - 16, header_padding);
+    assert(utils_is_zero(header_padding, header_size - 16));
+    allocator_free(header_padding);
 
     // read the composition count
     uint32_t num_compositions;
@@ -380,7 +417,7 @@ void aet_open(const char *path, struct aet_t *aet)
 
     // initialize the aet
     aet->num_compositions = num_compositions;
-    aet->compositions = malloc(num_compositions * sizeof(struct aet_composition_t));
+    aet->compositions = allocator_malloc(num_compositions * sizeof(struct aet_composition_t));
 
     // read the compositions
     for (int i = 0; i < num_compositions; i++)
@@ -415,7 +452,7 @@ void aet_open(const char *path, struct aet_t *aet)
 
             // read all the scr names
             composition.num_scr_names = num_scr_names;
-            composition.scr_names = malloc(num_scr_names * sizeof(char *));
+            composition.scr_names = allocator_malloc(num_scr_names * sizeof(char *));
             for (int i = 0; i < num_scr_names; i++)
             {
                 // pointer table
@@ -456,8 +493,9 @@ void aet_open(const char *path, struct aet_t *aet)
             assert(height == 240 || height == 720);
 
             // padding
-            for (int i = 0; i < 4; i++)
-                assert(fgetc(file) == 0x0);
+            uint8_t size_padding[4];
+            utils_read_block(file, ftell(file), sizeof(size_padding), size_padding);
+            assert(utils_is_zero(size_padding, sizeof(size_padding)));
 
             // initialize the composition
             composition.timeline_start_frame = timeline_start_frame;
@@ -477,30 +515,28 @@ void aet_open(const char *path, struct aet_t *aet)
             fread(&sprite_groups_pointer, sizeof(sprite_groups_pointer), 1, file);
 
             // padding
-            for (int i = 0; i < 5; i++)
-                assert(fgetc(file) == 0x0);
+            uint8_t sprite_groups_padding[5];
+            utils_read_block(file, ftell(file), sizeof(sprite_groups_padding), sprite_groups_padding);
+            assert(utils_is_zero(sprite_groups_padding, sizeof(sprite_groups_padding)));
 
             // read the sprite groups
             // need to read the first so that layers can point to them
             // keep the pointers to the sprite groups to keep track of
             // which is which when matching them to layers
             size_t sprite_group_pointers[num_sprite_groups];
+            uint8_t *sprite_groups = allocator_malloc(num_sprite_groups * aet_sprite_group_size);
+            utils_read_block(file, sprite_groups_pointer, num_sprite_groups * aet_sprite_group_size, sprite_groups);
+
             composition.num_sprite_groups = num_sprite_groups;
-            composition.sprite_groups = malloc(num_sprite_groups * sizeof(struct aet_sprite_group_t));
+            composition.sprite_groups = allocator_malloc(num_sprite_groups * sizeof(struct aet_sprite_group_t));
             for (int i = 0; i < num_sprite_groups; i++)
             {
-                // array
-                fseek(file, sprite_groups_pointer + (i * 20), SEEK_SET);
-
-                // insert the pointer
-                sprite_group_pointers[i] = ftell(file);
-
-                // read and insert the sprite group
-                struct aet_sprite_group_t sprite_group;
-                aet_sprite_group_read(file, &sprite_group);
-                composition.sprite_groups[i] = sprite_group;
+                sprite_group_pointers[i] = sprite_groups_pointer + (i * aet_sprite_group_size);
+                aet_sprite_group_read(file, sprite_groups + (i * aet_sprite_group_size), &composition.sprite_groups[i]);
             }
 
+            allocator_free(sprite_groups);
+
             // read the layers
             //
             // its difficult to understand what the purpose of layer levels are
@@ -516,46 +552,38 @@ void aet_open(const char *path, struct aet_t *aet)
             //
             // iterate through the groups once first to get the total layer count
             // and avoid any annoying realloc business
+            uint8_t layer_levels[num_layer_levels * 8];
+            utils_read_block(file, layer_levels_pointer, num_layer_levels * 8, layer_levels);
+
             unsigned int num_layers = 0;
             for (int level = 0; level < num_layer_levels; level++)
-            {
-                // array
-                fseek(file, layer_levels_pointer + (level * 8), SEEK_SET);
-
-                // read the group layer count and increment the total
-                uint32_t num_group_layers;
-                fread(&num_group_layers, sizeof(num_group_layers), 1, file);
-
-                num_layers += num_group_layers;
-            }
+                num_layers += utils_load_u32(layer_levels + (level * 8));
 
             // reiterate and read all the groups and their layers
             composition.num_layers = num_layers;
-            composition.layers = malloc(num_layers * sizeof(struct aet_layer_t));
+            composition.layers = allocator_malloc(num_layers * sizeof(struct aet_layer_t));
 
             unsigned int layer_index = 0;
             size_t layer_pointers[num_layers];
             for (int level = 0; level < num_layer_levels; level++)
             {
-                // array
-                fseek(file, layer_levels_pointer + (level * 8), SEEK_SET);
+                // group layer count and pointer
+                uint32_t num_group_layers = utils_load_u32(layer_levels + (level * 8));
+                uint32_t group_layers_pointer = utils_load_u32(layer_levels + (level * 8) + 4);
 
-                // read the group layer count and pointer
-                uint32_t num_group_layers, group_layers_pointer;
-                fread(&num_group_layers, sizeof(num_group_layers), 1, file);
-                fread(&group_layers_pointer, sizeof(group_layers_pointer), 1, file);
+                // read all the layers within this group at once
+                uint8_t *group_layers = allocator_malloc(num_group_layers * aet_layer_size);
+                utils_read_block(file, group_layers_pointer, num_group_layers * aet_layer_size, group_layers);
 
-                // read all the layers within this group
                 for (int layer = 0; layer < num_group_layers; layer++)
                 {
-                    // array
-                    fseek(file, group_layers_pointer + (layer * 48), SEEK_SET);
-
                     // set the pointer, read, and insert the layer
-                    layer_pointers[layer_index] = ftell(file);
+                    layer_pointers[layer_index] = group_layers_pointer + (layer * aet_layer_size);
+                    const uint8_t *layer_data = group_layers + (layer * aet_layer_size);
 
                     struct aet_layer_t *layer = &composition.layers[layer_index];
                     aet_layer_read(file,
+                                   layer_data,
                                    num_layers,
                                    composition.layers,
                                    layer_pointers,
@@ -572,6 +600,8 @@ void aet_open(const char *path, struct aet_t *aet)
                     // increment the layer index
                     layer_index++;
                 }
+
+                allocator_free(group_layers);
             }
 
             // assert that the correct amount of layers were read
@@ -587,11 +617,11 @@ void aet_open(const char *path, struct aet_t *aet)
 /// @param keyframes The layer keyframes to free.
 void aet_layer_keyframes_free(struct aet_layer_keyframes_t *keyframes)
 {
-    free(keyframes->values);
+    allocator_free(keyframes->values);
     switch (keyframes->type)
     {
         case AET_LAYER_KEYFRAMES_TYPE_MULTIPLE:
-            free(keyframes->frames);
+            allocator_free(keyframes->frames);
             break;
         default:
             break;
@@ -604,7 +634,7 @@ void aet_close(struct aet_t *aet)
     {
         struct aet_composition_t *composition = &aet->compositions[i];
         for (int i = 0; i < composition->num_scr_names; i++)
-            free(composition->scr_names[i]);
+            allocator_free(composition->scr_names[i]);
 
         for (int i = 0; i < composition->num_layers; i++)
         {
@@ -612,16 +642,16 @@ void aet_close(struct aet_t *aet)
             switch (layer->type)
             {
                 case AET_LAYER_TYPE_NULL_OBJECT:
-                    free(layer->children);
+                    allocator_free(layer->children);
                     break;
                 default:
                     break;
             }
 
             for (int i = 0; i < layer->num_markers; i++)
-                free(layer->markers[i].name);
+                allocator_free(layer->markers[i].name);
 
-            free(layer->markers);
+            allocator_free(layer->markers);
 
             aet_layer_keyframes_free(&layer->anchor_point_x);
             aet_layer_keyframes_free(&layer->anchor_point_y);
@@ -633,19 +663,67 @@ void aet_close(struct aet_t *aet)
             aet_layer_keyframes_free(&layer->opacity);
         }
 
-        free(composition->sprite_groups);
-        free(composition->layers);
-        free(composition->scr_names);
-        free(composition->name);
+        allocator_free(composition->sprite_groups);
+        allocator_free(composition->layers);
+        allocator_free(composition->scr_names);
+        allocator_free(composition->name);
     }
 
-    free(aet->compositions);
+    allocator_free(aet->compositions);
     fclose(aet->file);
 }
 
+uint32_t aet_marker_name_hash(const char *name, size_t length)
+{
+    uint32_t hash = 0x811c9dc5;
+    for (size_t i = 0; i < length; i++)
+    {
+        hash ^= (uint8_t)name[i];
+        hash *= 0x01000193;
+    }
+
+    return hash;
+}
+
 double aet_frame_to_ms(float frame, float framerate, float speed)
 {
     double frame_duration = (1 / framerate) * 1000;
     double frame_ms = (frame * frame_duration) / speed;
     return frame_ms;
 }
+
+float aet_layer_keyframes_sample(const struct aet_layer_keyframes_t *keyframes, float frame)
+{
+    if (keyframes->type == AET_LAYER_KEYFRAMES_TYPE_SINGLE)
+        return keyframes->values[0];
+
+    // clamp to the first and last keyframes
+    unsigned int last = keyframes->num_keyframes - 1;
+    if (frame <= keyframes->frames[0])
+        return keyframes->values[0];
+    if (frame >= keyframes->frames[last])
+        return keyframes->values[last];
+
+    // find the last keyframe at or before the frame
+    unsigned int low = 0, high = last;
+    while (high - low > 1)
+    {
+        unsigned int middle = low + (high - low) / 2;
+        if (keyframes->frames[middle] <= frame)
+            low = middle;
+        else
+            high = middle;
+    }
+
+    // interpolate towards the next keyframe
+    float start_frame = keyframes->frames[low];
+    float end_frame = keyframes->frames[high];
+    float progress = (frame - start_frame) / (end_frame - start_frame);
+    return keyframes->values[low] + ((keyframes->values[high] - keyframes->values[low]) * progress);
+}
+
+float aet_layer_frame(const struct aet_layer_t *layer, float parent_frame)
+{
+    // the speed is normalized the same as in aet_frame_to_ms
+    return (parent_frame - layer->timeline_start_frame) * layer->timeline_speed;
+}
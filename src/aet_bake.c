@@ -0,0 +1,382 @@
+//
+//  aet_bake.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "aet_bake.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "allocator.h"
+#include "aet_state.h"
+
+// MARK: - Constants
+
+/// The signature at the beginning of every saved bake file.
+const char aet_bake_signature[4] = { 'M', 'B', 'A', 'K' };
+
+/// The version of the saved bake file format.
+///
+/// This must be incremented whenever the layout of saved bakes changes.
+const uint32_t aet_bake_version = 1;
+
+// MARK: - Data Structures
+
+/// The data structure for a contiguous range of samples to be baked by a single thread.
+struct aet_bake_job_t
+{
+    /// The bake being filled.
+    struct aet_bake_t *bake;
+
+    /// The timeline of the composition being baked.
+    const struct aet_timeline_t *timeline;
+
+    /// The number of baked layers that each sample has room for, within the bake's `baked_layers`,
+    /// starting from the sample's item within the bake's `layer_offsets`.
+    const uint32_t *capacities;
+
+    /// The number of baked layers actually written for each sample.
+    uint32_t *counts;
+
+    /// The index of the first sample within this job.
+    unsigned int first_frame;
+
+    /// The number of samples within this job.
+    unsigned int num_frames;
+
+    /// The allocator of the thread that started this job, for the thread running it to allocate with.
+    const struct allocator_t *allocator;
+};
+
+// MARK: - Functions
+
+/// Get the frame number within the composition's timeline of the sample at the given index of the given bake.
+///
+/// This is calculated from the index each time rather than accumulated,
+/// so samples late into long compositions do not drift.
+/// @param bake The bake to get the frame number from.
+/// @param index The index of the sample to get the frame number of.
+/// @returns The frame number of the sample at the given index of the given bake.
+float aet_bake_sample_frame(const struct aet_bake_t *bake, unsigned int index)
+{
+    return (float)((double)bake->start_frame + ((double)index * (double)bake->frame_step));
+}
+
+/// Bake all the samples within the given job.
+/// @param argument The job to bake, as a `struct aet_bake_job_t *`.
+/// @returns `NULL`, for use with `pthread_create`.
+void *aet_bake_job_run(void *argument)
+{
+    struct aet_bake_job_t *job = argument;
+    struct aet_bake_t *bake = job->bake;
+    const struct allocator_t *previous_allocator = allocator_set_thread(job->allocator);
+
+    struct aet_state_t state;
+    aet_state_create(job->timeline, &state);
+    for (unsigned int i = job->first_frame; i < job->first_frame + job->num_frames; i++)
+    {
+        aet_state_evaluate(&state, aet_bake_sample_frame(bake, i));
+        assert(state.num_layer_states <= job->capacities[i]);
+
+        struct aet_baked_layer_t *baked_layers = &bake->baked_layers[bake->layer_offsets[i]];
+        for (int l = 0; l < state.num_layer_states; l++)
+        {
+            const struct aet_layer_state_t *layer_state = &state.layer_states[l];
+            struct aet_baked_layer_t *baked_layer = &baked_layers[l];
+            baked_layer->layer_index = (uint16_t)layer_state->layer_index;
+            baked_layer->sprite_index = (uint16_t)layer_state->sprite_index;
+            baked_layer->opacity = layer_state->opacity;
+            baked_layer->world_matrix = layer_state->world_matrix;
+        }
+
+        job->counts[i] = state.num_layer_states;
+    }
+
+    aet_state_destroy(&state);
+    allocator_set_thread(previous_allocator);
+    return NULL;
+}
+
+void aet_bake_create(const struct aet_timeline_t *timeline,
+                     float frame_rate,
+                     unsigned int num_threads,
+                     struct aet_bake_t *bake)
+{
+    const struct aet_composition_t *composition = timeline->composition;
+    assert(timeline->num_layers <= UINT16_MAX);
+
+    if (frame_rate <= 0)
+        frame_rate = composition->timeline_frame_rate;
+
+    // get the samples covering the composition's timeline
+    float frame_step = composition->timeline_frame_rate / frame_rate;
+    float duration = composition->timeline_end_frame - composition->timeline_start_frame;
+    unsigned int num_frames = 0;
+    if (duration > 0)
+        num_frames = (unsigned int)ceilf(duration / frame_step);
+
+    bake->frame_rate = frame_rate;
+    bake->start_frame = composition->timeline_start_frame;
+    bake->frame_step = frame_step;
+    bake->num_layers = timeline->num_layers;
+    bake->num_frames = num_frames;
+    bake->layer_offsets = allocator_malloc((num_frames + 1) * sizeof(uint32_t));
+
+    // sweep the timeline once to get an upper bound on the visible layers of each sample
+    // this is every active sprite group layer, regardless of opacity
+    uint32_t *capacities = allocator_malloc((num_frames + 1) * sizeof(uint32_t));
+    unsigned int *entered = allocator_malloc(timeline->num_layers * sizeof(unsigned int));
+    unsigned int *exited = allocator_malloc(timeline->num_layers * sizeof(unsigned int));
+    unsigned int num_entered, num_exited;
+
+    struct aet_timeline_cursor_t cursor;
+    aet_timeline_cursor_seek(timeline, -INFINITY, &cursor);
+
+    uint32_t num_active = 0;
+    uint32_t total_capacity = 0;
+    for (unsigned int i = 0; i < num_frames; i++)
+    {
+        aet_timeline_cursor_advance(&cursor, aet_bake_sample_frame(bake, i), entered, &num_entered, exited, &num_exited);
+        for (int e = 0; e < num_entered; e++)
+            if (composition->layers[entered[e]].type == AET_LAYER_TYPE_SOURCE_SPRITE_GROUP)
+                num_active++;
+        for (int e = 0; e < num_exited; e++)
+            if (composition->layers[exited[e]].type == AET_LAYER_TYPE_SOURCE_SPRITE_GROUP)
+                num_active--;
+
+        bake->layer_offsets[i] = total_capacity;
+        capacities[i] = num_active;
+        total_capacity += num_active;
+    }
+
+    allocator_free(exited);
+    allocator_free(entered);
+
+    // bake every sample into its own slot, split evenly over the threads
+    bake->baked_layers = allocator_malloc(total_capacity * sizeof(struct aet_baked_layer_t));
+    uint32_t *counts = allocator_malloc((num_frames + 1) * sizeof(uint32_t));
+
+    if (num_threads < 1)
+        num_threads = 1;
+    if (num_threads > num_frames)
+        num_threads = (num_frames > 0) ? num_frames : 1;
+
+    struct aet_bake_job_t *jobs = allocator_malloc(num_threads * sizeof(struct aet_bake_job_t));
+    pthread_t *threads = allocator_malloc(num_threads * sizeof(pthread_t));
+    int *started = allocator_malloc(num_threads * sizeof(int));
+    for (unsigned int t = 0; t < num_threads; t++)
+    {
+        unsigned int first_frame = (unsigned int)(((uint64_t)num_frames * t) / num_threads);
+        unsigned int last_frame = (unsigned int)(((uint64_t)num_frames * (t + 1)) / num_threads);
+        jobs[t].bake = bake;
+        jobs[t].timeline = timeline;
+        jobs[t].capacities = capacities;
+        jobs[t].counts = counts;
+        jobs[t].first_frame = first_frame;
+        jobs[t].num_frames = last_frame - first_frame;
+        jobs[t].allocator = allocator_get_thread();
+    }
+
+    // the calling thread takes the first job, and any job whose thread could not be created
+    for (unsigned int t = 1; t < num_threads; t++)
+        started[t] = (pthread_create(&threads[t], NULL, aet_bake_job_run, &jobs[t]) == 0);
+
+    aet_bake_job_run(&jobs[0]);
+
+    for (unsigned int t = 1; t < num_threads; t++)
+        if (!started[t])
+            aet_bake_job_run(&jobs[t]);
+
+    for (unsigned int t = 1; t < num_threads; t++)
+        if (started[t])
+            pthread_join(threads[t], NULL);
+
+    allocator_free(started);
+    allocator_free(threads);
+    allocator_free(jobs);
+
+    // compact the samples, removing the room left by layers which were not visible
+    uint32_t num_baked_layers = 0;
+    for (unsigned int i = 0; i < num_frames; i++)
+    {
+        memmove(&bake->baked_layers[num_baked_layers],
+                &bake->baked_layers[bake->layer_offsets[i]],
+                counts[i] * sizeof(struct aet_baked_layer_t));
+
+        bake->layer_offsets[i] = num_baked_layers;
+        num_baked_layers += counts[i];
+    }
+
+    bake->layer_offsets[num_frames] = num_baked_layers;
+    bake->num_baked_layers = num_baked_layers;
+    if (num_baked_layers < total_capacity)
+        bake->baked_layers = allocator_realloc(bake->baked_layers, num_baked_layers * sizeof(struct aet_baked_layer_t));
+
+    allocator_free(counts);
+    allocator_free(capacities);
+}
+
+void aet_bake_destroy(struct aet_bake_t *bake)
+{
+    allocator_free(bake->baked_layers);
+    allocator_free(bake->layer_offsets);
+}
+
+const struct aet_baked_layer_t *aet_bake_sample(const struct aet_bake_t *bake,
+                                                int index,
+                                                unsigned int *num_baked_layers)
+{
+    if (bake->num_frames == 0)
+    {
+        *num_baked_layers = 0;
+        return bake->baked_layers;
+    }
+
+    if (index < 0)
+        index = 0;
+    if (index >= bake->num_frames)
+        index = bake->num_frames - 1;
+
+    uint32_t offset = bake->layer_offsets[index];
+    *num_baked_layers = bake->layer_offsets[index + 1] - offset;
+    return &bake->baked_layers[offset];
+}
+
+const struct aet_baked_layer_t *aet_bake_lookup(const struct aet_bake_t *bake,
+                                                float frame,
+                                                unsigned int *num_baked_layers)
+{
+    // clamp before converting to avoid overflowing the index
+    double index = floor(((double)frame - (double)bake->start_frame) / (double)bake->frame_step);
+    if (index < 0)
+        index = 0;
+    if (index > bake->num_frames)
+        index = bake->num_frames;
+
+    return aet_bake_sample(bake, (int)index, num_baked_layers);
+}
+
+int aet_bake_save(const struct aet_bake_t *bake, const char *path)
+{
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return 0;
+
+    // write the header
+    uint32_t baked_layer_size = sizeof(struct aet_baked_layer_t);
+    uint32_t num_layers = bake->num_layers;
+    uint32_t num_frames = bake->num_frames;
+    uint32_t num_baked_layers = bake->num_baked_layers;
+    fwrite(aet_bake_signature, sizeof(aet_bake_signature), 1, file);
+    fwrite(&aet_bake_version, sizeof(aet_bake_version), 1, file);
+    fwrite(&baked_layer_size, sizeof(baked_layer_size), 1, file);
+    fwrite(&bake->frame_rate, sizeof(bake->frame_rate), 1, file);
+    fwrite(&bake->start_frame, sizeof(bake->start_frame), 1, file);
+    fwrite(&bake->frame_step, sizeof(bake->frame_step), 1, file);
+    fwrite(&num_layers, sizeof(num_layers), 1, file);
+    fwrite(&num_frames, sizeof(num_frames), 1, file);
+    fwrite(&num_baked_layers, sizeof(num_baked_layers), 1, file);
+
+    // write the tables
+    fwrite(bake->layer_offsets, sizeof(uint32_t), num_frames + 1, file);
+    fwrite(bake->baked_layers, sizeof(struct aet_baked_layer_t), num_baked_layers, file);
+
+    int success = !ferror(file);
+    success &= (fclose(file) == 0);
+    return success;
+}
+
+int aet_bake_load(const char *path, const struct aet_timeline_t *timeline, struct aet_bake_t *bake)
+{
+    const struct aet_composition_t *composition = timeline->composition;
+    unsigned int num_layers = timeline->num_layers;
+
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return 0;
+
+    // read and validate the header
+    // anything unexpected means the bake is stale, so reject it rather than asserting
+    char signature[sizeof(aet_bake_signature)];
+    uint32_t version, baked_layer_size, file_num_layers, num_frames, num_baked_layers;
+    float frame_rate, start_frame, frame_step;
+    int valid = 1;
+    valid &= fread(signature, sizeof(signature), 1, file);
+    valid &= fread(&version, sizeof(version), 1, file);
+    valid &= fread(&baked_layer_size, sizeof(baked_layer_size), 1, file);
+    valid &= fread(&frame_rate, sizeof(frame_rate), 1, file);
+    valid &= fread(&start_frame, sizeof(start_frame), 1, file);
+    valid &= fread(&frame_step, sizeof(frame_step), 1, file);
+    valid &= fread(&file_num_layers, sizeof(file_num_layers), 1, file);
+    valid &= fread(&num_frames, sizeof(num_frames), 1, file);
+    valid &= fread(&num_baked_layers, sizeof(num_baked_layers), 1, file);
+    if (!valid ||
+        memcmp(signature, aet_bake_signature, sizeof(signature)) != 0 ||
+        version != aet_bake_version ||
+        baked_layer_size != sizeof(struct aet_baked_layer_t) ||
+        file_num_layers != num_layers ||
+        !(frame_step > 0) ||
+        !isfinite(frame_step) ||
+        !isfinite(start_frame))
+    {
+        fclose(file);
+        return 0;
+    }
+
+    // reject tables larger than the rest of the file before allocating them
+    long tables_start = ftell(file);
+    fseek(file, 0, SEEK_END);
+    uint64_t tables_size = (uint64_t)(ftell(file) - tables_start);
+    fseek(file, tables_start, SEEK_SET);
+    if (((uint64_t)num_frames + 1) * sizeof(uint32_t) + (uint64_t)num_baked_layers * sizeof(struct aet_baked_layer_t) != tables_size)
+    {
+        fclose(file);
+        return 0;
+    }
+
+    // read the tables
+    uint32_t *layer_offsets = allocator_malloc((num_frames + 1) * sizeof(uint32_t));
+    struct aet_baked_layer_t *baked_layers = allocator_malloc(num_baked_layers * sizeof(struct aet_baked_layer_t));
+    valid &= (fread(layer_offsets, sizeof(uint32_t), num_frames + 1, file) == num_frames + 1);
+    valid &= (fread(baked_layers, sizeof(struct aet_baked_layer_t), num_baked_layers, file) == num_baked_layers);
+    fclose(file);
+
+    // the offsets must be ascending and end at the total, so that every sample's range is within the baked layers
+    valid = valid && (layer_offsets[0] == 0) && (layer_offsets[num_frames] == num_baked_layers);
+    for (unsigned int i = 0; valid && i < num_frames; i++)
+        valid = (layer_offsets[i] <= layer_offsets[i + 1]);
+
+    // every baked layer must display a sprite that exists within the composition
+    const struct aet_layer_t *layers = composition->layers;
+    for (unsigned int i = 0; valid && i < num_baked_layers; i++)
+    {
+        unsigned int layer_index = baked_layers[i].layer_index;
+        valid = (layer_index < num_layers) &&
+                (layers[layer_index].type == AET_LAYER_TYPE_SOURCE_SPRITE_GROUP) &&
+                (baked_layers[i].sprite_index < layers[layer_index].sprite_group->num_sprites);
+    }
+
+    if (!valid)
+    {
+        allocator_free(baked_layers);
+        allocator_free(layer_offsets);
+        return 0;
+    }
+
+    bake->frame_rate = frame_rate;
+    bake->start_frame = start_frame;
+    bake->frame_step = frame_step;
+    bake->num_layers = num_layers;
+    bake->num_frames = num_frames;
+    bake->layer_offsets = layer_offsets;
+    bake->num_baked_layers = num_baked_layers;
+    bake->baked_layers = baked_layers;
+    return 1;
+}
@@ -0,0 +1,407 @@
+//
+//  aet_batch.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "aet_batch.h"
+
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include <assert.h>
+
+#include "allocator.h"
+
+// MARK: - Functions
+
+void aet_batch_create(const struct aet_timeline_t *timeline, unsigned int max_instances, struct aet_batch_t *batch)
+{
+    size_t num_values = (size_t)timeline->num_layers * max_instances;
+    batch->timeline = timeline;
+    batch->max_instances = max_instances;
+    batch->num_instances = 0;
+    batch->frames = allocator_malloc(max_instances * sizeof(float));
+    batch->layer_frames = allocator_malloc(num_values * sizeof(float));
+    batch->opacities = allocator_calloc(num_values, sizeof(float));
+    batch->sprite_indices = allocator_calloc(num_values, sizeof(unsigned int));
+    batch->world_a = allocator_malloc(num_values * sizeof(float));
+    batch->world_b = allocator_malloc(num_values * sizeof(float));
+    batch->world_c = allocator_malloc(num_values * sizeof(float));
+    batch->world_d = allocator_malloc(num_values * sizeof(float));
+    batch->world_tx = allocator_malloc(num_values * sizeof(float));
+    batch->world_ty = allocator_malloc(num_values * sizeof(float));
+    batch->keyframe_indices = allocator_malloc(max_instances * sizeof(unsigned int));
+    batch->scratch = allocator_malloc(8 * max_instances * sizeof(float));
+}
+
+void aet_batch_destroy(struct aet_batch_t *batch)
+{
+    allocator_free(batch->scratch);
+    allocator_free(batch->keyframe_indices);
+    allocator_free(batch->world_ty);
+    allocator_free(batch->world_tx);
+    allocator_free(batch->world_d);
+    allocator_free(batch->world_c);
+    allocator_free(batch->world_b);
+    allocator_free(batch->world_a);
+    allocator_free(batch->sprite_indices);
+    allocator_free(batch->opacities);
+    allocator_free(batch->layer_frames);
+    allocator_free(batch->frames);
+}
+
+/// Sample the given keyframes at each of the given frames.
+///
+/// This matches `aet_layer_keyframes_sample(keyframes, frame)`, but splits the search for each frame's keyframes
+/// from the interpolation, so that the interpolation of every frame is a single vectorizable loop.
+/// @param keyframes The keyframes to sample.
+/// @param num_frames The total number of frames to sample at.
+/// @param frames The frame numbers within the keyframes' timeline to sample at.
+/// @param keyframe_indices Scratch storage with room for `num_frames` items.
+/// @param progresses Scratch storage with room for `num_frames` items.
+/// @param values The array to write the sampled value at each frame to.
+void aet_batch_keyframes_sample(const struct aet_layer_keyframes_t *keyframes,
+                                unsigned int num_frames,
+                                const float *restrict frames,
+                                unsigned int *restrict keyframe_indices,
+                                float *restrict progresses,
+                                float *restrict values)
+{
+    if (keyframes->type == AET_LAYER_KEYFRAMES_TYPE_SINGLE || keyframes->num_keyframes == 1)
+    {
+        float value = keyframes->values[0];
+        for (unsigned int i = 0; i < num_frames; i++)
+            values[i] = value;
+        return;
+    }
+
+    // find the keyframe pair surrounding each frame
+    // frames at or outside of the first and last keyframes are clamped to exactly their values,
+    // the same as aet_layer_keyframes_sample, by sampling that keyframe with no progress
+    const float *keyframe_frames = keyframes->frames;
+    const float *keyframe_values = keyframes->values;
+    unsigned int last = keyframes->num_keyframes - 1;
+    for (unsigned int i = 0; i < num_frames; i++)
+    {
+        float frame = frames[i];
+        if (frame <= keyframe_frames[0])
+        {
+            progresses[i] = 0;
+            keyframe_indices[i] = 0;
+            continue;
+        }
+        if (frame >= keyframe_frames[last])
+        {
+            progresses[i] = 0;
+            keyframe_indices[i] = last;
+            continue;
+        }
+
+        unsigned int low = 0, high = last;
+        while (high - low > 1)
+        {
+            unsigned int middle = low + (high - low) / 2;
+            if (keyframe_frames[middle] <= frame)
+                low = middle;
+            else
+                high = middle;
+        }
+
+        progresses[i] = (frame - keyframe_frames[low]) / (keyframe_frames[high] - keyframe_frames[low]);
+        keyframe_indices[i] = low;
+    }
+
+    // interpolate within each pair
+    for (unsigned int i = 0; i < num_frames; i++)
+    {
+        unsigned int low = keyframe_indices[i];
+        float start_value = keyframe_values[low];
+        float end_value = keyframe_values[low + (low < last)];
+        values[i] = start_value + ((end_value - start_value) * progresses[i]);
+    }
+}
+
+/// Build the local matrix of each instance of a layer from it's sampled properties.
+///
+/// This matches `aet_layer_matrix(layer, layer_frame)`, with the components of each matrix written to their own rows.
+/// @param num_instances The total number of instances to build the matrices of.
+/// @param constant_rotation Whether or not the rotation is the same for every instance,
+/// in which case it's sine and cosine are only calculated once.
+/// @param anchor_point_x The sampled X anchor point of each instance.
+/// @param anchor_point_y The sampled Y anchor point of each instance.
+/// @param position_x The sampled X position of each instance.
+/// @param position_y The sampled Y position of each instance.
+/// @param rotation The sampled rotation of each instance, in degrees.
+/// @param scale_x The sampled X scale of each instance.
+/// @param scale_y The sampled Y scale of each instance.
+/// @param a The row to write the `a` component of each matrix to.
+/// @param b The row to write the `b` component of each matrix to.
+/// @param c The row to write the `c` component of each matrix to.
+/// @param d The row to write the `d` component of each matrix to.
+/// @param tx The row to write the `tx` component of each matrix to.
+/// @param ty The row to write the `ty` component of each matrix to.
+void aet_batch_matrices_build(unsigned int num_instances,
+                              int constant_rotation,
+                              const float *restrict anchor_point_x,
+                              const float *restrict anchor_point_y,
+                              const float *restrict position_x,
+                              const float *restrict position_y,
+                              const float *restrict rotation,
+                              const float *restrict scale_x,
+                              const float *restrict scale_y,
+                              float *restrict a,
+                              float *restrict b,
+                              float *restrict c,
+                              float *restrict d,
+                              float *restrict tx,
+                              float *restrict ty)
+{
+    // the trigonometry is kept out of the main loop so that the rest vectorizes
+    // the cosine and sine are held within the c and d rows until they are needed
+    if (constant_rotation)
+    {
+        float radians = rotation[0] * (float)M_PI / 180;
+        float cosine = cosf(radians);
+        float sine = sinf(radians);
+        for (unsigned int i = 0; i < num_instances; i++)
+        {
+            c[i] = cosine;
+            d[i] = sine;
+        }
+    }
+    else
+    {
+        for (unsigned int i = 0; i < num_instances; i++)
+        {
+            float radians = rotation[i] * (float)M_PI / 180;
+            c[i] = cosf(radians);
+            d[i] = sinf(radians);
+        }
+    }
+
+    // position * rotation * scale * -anchor point, expanded
+    for (unsigned int i = 0; i < num_instances; i++)
+    {
+        float cosine = c[i];
+        float sine = d[i];
+        a[i] = cosine * scale_x[i];
+        b[i] = sine * scale_x[i];
+        c[i] = -sine * scale_y[i];
+        d[i] = cosine * scale_y[i];
+        tx[i] = position_x[i] - (a[i] * anchor_point_x[i]) - (c[i] * anchor_point_y[i]);
+        ty[i] = position_y[i] - (b[i] * anchor_point_x[i]) - (d[i] * anchor_point_y[i]);
+    }
+}
+
+/// Transform the matrix of each instance of a layer by the matrix of the same instance of it's parent.
+///
+/// This matches `matrix2d_multiply(parent, matrix)`, with the components of each matrix within their own rows.
+/// @param num_instances The total number of instances to transform the matrices of.
+/// @param parent_a The row of the `a` component of each parent matrix.
+/// @param parent_b The row of the `b` component of each parent matrix.
+/// @param parent_c The row of the `c` component of each parent matrix.
+/// @param parent_d The row of the `d` component of each parent matrix.
+/// @param parent_tx The row of the `tx` component of each parent matrix.
+/// @param parent_ty The row of the `ty` component of each parent matrix.
+/// @param a The row of the `a` component of each matrix to transform.
+/// @param b The row of the `b` component of each matrix to transform.
+/// @param c The row of the `c` component of each matrix to transform.
+/// @param d The row of the `d` component of each matrix to transform.
+/// @param tx The row of the `tx` component of each matrix to transform.
+/// @param ty The row of the `ty` component of each matrix to transform.
+void aet_batch_matrices_multiply(unsigned int num_instances,
+                                 const float *restrict parent_a,
+                                 const float *restrict parent_b,
+                                 const float *restrict parent_c,
+                                 const float *restrict parent_d,
+                                 const float *restrict parent_tx,
+                                 const float *restrict parent_ty,
+                                 float *restrict a,
+                                 float *restrict b,
+                                 float *restrict c,
+                                 float *restrict d,
+                                 float *restrict tx,
+                                 float *restrict ty)
+{
+    for (unsigned int i = 0; i < num_instances; i++)
+    {
+        float local_a = a[i], local_b = b[i], local_c = c[i], local_d = d[i], local_tx = tx[i], local_ty = ty[i];
+        a[i] = (parent_a[i] * local_a) + (parent_c[i] * local_b);
+        b[i] = (parent_b[i] * local_a) + (parent_d[i] * local_b);
+        c[i] = (parent_a[i] * local_c) + (parent_c[i] * local_d);
+        d[i] = (parent_b[i] * local_c) + (parent_d[i] * local_d);
+        tx[i] = (parent_a[i] * local_tx) + (parent_c[i] * local_ty) + parent_tx[i];
+        ty[i] = (parent_b[i] * local_tx) + (parent_d[i] * local_ty) + parent_ty[i];
+    }
+}
+
+void aet_batch_evaluate(struct aet_batch_t *batch,
+                        unsigned int num_instances,
+                        const float *frames,
+                        const struct matrix2d_t *root_matrices)
+{
+    const struct aet_timeline_t *timeline = batch->timeline;
+    const struct aet_composition_t *composition = timeline->composition;
+    unsigned int max_instances = batch->max_instances;
+    unsigned int n = num_instances;
+    assert(num_instances <= max_instances);
+
+    for (unsigned int i = 0; i < n; i++)
+        batch->frames[i] = frames[i];
+
+    unsigned int *keyframe_indices = batch->keyframe_indices;
+    float *progresses = &batch->scratch[0 * max_instances];
+    float *anchor_point_x = &batch->scratch[1 * max_instances];
+    float *anchor_point_y = &batch->scratch[2 * max_instances];
+    float *position_x = &batch->scratch[3 * max_instances];
+    float *position_y = &batch->scratch[4 * max_instances];
+    float *rotation = &batch->scratch[5 * max_instances];
+    float *scale_x = &batch->scratch[6 * max_instances];
+    float *scale_y = &batch->scratch[7 * max_instances];
+
+    // the draw order has parents before their children,
+    // so the rows of a parent are always evaluated by the time they are needed
+    for (unsigned int o = 0; o < timeline->num_layers; o++)
+    {
+        unsigned int layer_index = timeline->draw_order[o];
+        const struct aet_layer_t *layer = &composition->layers[layer_index];
+        size_t row = (size_t)layer_index * max_instances;
+        float *restrict layer_frames = &batch->layer_frames[row];
+        float *restrict opacities = &batch->opacities[row];
+
+        // skip layers which are not active for any instance
+        float start_frame = timeline->start_frames[layer_index];
+        float end_frame = timeline->end_frames[layer_index];
+        int any_active = 0;
+        for (unsigned int i = 0; i < n; i++)
+            any_active |= (start_frame <= frames[i]) & (frames[i] < end_frame);
+
+        if (!any_active)
+        {
+            for (unsigned int i = 0; i < n; i++)
+                opacities[i] = 0;
+            continue;
+        }
+
+        float frame_scale = timeline->frame_scales[layer_index];
+        float frame_offset = timeline->frame_offsets[layer_index];
+        for (unsigned int i = 0; i < n; i++)
+            layer_frames[i] = (frames[i] * frame_scale) + frame_offset;
+
+        // sample every property of every instance
+        aet_batch_keyframes_sample(&layer->anchor_point_x, n, layer_frames, keyframe_indices, progresses, anchor_point_x);
+        aet_batch_keyframes_sample(&layer->anchor_point_y, n, layer_frames, keyframe_indices, progresses, anchor_point_y);
+        aet_batch_keyframes_sample(&layer->position_x, n, layer_frames, keyframe_indices, progresses, position_x);
+        aet_batch_keyframes_sample(&layer->position_y, n, layer_frames, keyframe_indices, progresses, position_y);
+        aet_batch_keyframes_sample(&layer->rotation, n, layer_frames, keyframe_indices, progresses, rotation);
+        aet_batch_keyframes_sample(&layer->scale_x, n, layer_frames, keyframe_indices, progresses, scale_x);
+        aet_batch_keyframes_sample(&layer->scale_y, n, layer_frames, keyframe_indices, progresses, scale_y);
+        aet_batch_keyframes_sample(&layer->opacity, n, layer_frames, keyframe_indices, progresses, opacities);
+
+        // build the local matrices, then transform them into the parent, or the root of each instance
+        float *a = &batch->world_a[row];
+        float *b = &batch->world_b[row];
+        float *c = &batch->world_c[row];
+        float *d = &batch->world_d[row];
+        float *tx = &batch->world_tx[row];
+        float *ty = &batch->world_ty[row];
+        int constant_rotation = (layer->rotation.type == AET_LAYER_KEYFRAMES_TYPE_SINGLE);
+        aet_batch_matrices_build(n,
+                                 constant_rotation,
+                                 anchor_point_x,
+                                 anchor_point_y,
+                                 position_x,
+                                 position_y,
+                                 rotation,
+                                 scale_x,
+                                 scale_y,
+                                 a, b, c, d, tx, ty);
+
+        unsigned int parent_index = timeline->parent_indices[layer_index];
+        if (parent_index != UINT_MAX)
+        {
+            size_t parent_row = (size_t)parent_index * max_instances;
+            aet_batch_matrices_multiply(n,
+                                        &batch->world_a[parent_row],
+                                        &batch->world_b[parent_row],
+                                        &batch->world_c[parent_row],
+                                        &batch->world_d[parent_row],
+                                        &batch->world_tx[parent_row],
+                                        &batch->world_ty[parent_row],
+                                        a, b, c, d, tx, ty);
+
+            const float *parent_opacities = &batch->opacities[parent_row];
+            for (unsigned int i = 0; i < n; i++)
+                opacities[i] *= parent_opacities[i];
+        }
+        else if (root_matrices != NULL)
+        {
+            for (unsigned int i = 0; i < n; i++)
+            {
+                struct matrix2d_t local = { a[i], b[i], c[i], d[i], tx[i], ty[i] };
+                struct matrix2d_t world = matrix2d_multiply(root_matrices[i], local);
+                a[i] = world.a;
+                b[i] = world.b;
+                c[i] = world.c;
+                d[i] = world.d;
+                tx[i] = world.tx;
+                ty[i] = world.ty;
+            }
+        }
+
+        // layers which are not active for an instance are fully transparent
+        for (unsigned int i = 0; i < n; i++)
+            if (!((start_frame <= frames[i]) & (frames[i] < end_frame)))
+                opacities[i] = 0;
+
+        // sprite groups with multiple sprites are played as a flipbook, the same as aet_state_evaluate
+        if (layer->type == AET_LAYER_TYPE_SOURCE_SPRITE_GROUP && layer->sprite_group->num_sprites > 0)
+        {
+            unsigned int *restrict sprite_indices = &batch->sprite_indices[row];
+            float last_sprite = layer->sprite_group->num_sprites - 1;
+            for (unsigned int i = 0; i < n; i++)
+                sprite_indices[i] = (unsigned int)fminf(fmaxf(floorf(layer_frames[i]), 0), last_sprite);
+        }
+    }
+
+    batch->num_instances = n;
+}
+
+void aet_batch_instance_state(const struct aet_batch_t *batch,
+                              unsigned int instance_index,
+                              struct aet_state_t *state)
+{
+    const struct aet_timeline_t *timeline = batch->timeline;
+    const struct aet_composition_t *composition = timeline->composition;
+
+    unsigned int num_layer_states = 0;
+    for (unsigned int o = 0; o < timeline->num_layers; o++)
+    {
+        unsigned int layer_index = timeline->draw_order[o];
+        const struct aet_layer_t *layer = &composition->layers[layer_index];
+        size_t index = ((size_t)layer_index * batch->max_instances) + instance_index;
+
+        // only sprite group layers with something to show are visible
+        if (layer->type != AET_LAYER_TYPE_SOURCE_SPRITE_GROUP)
+            continue;
+        if (batch->opacities[index] <= 0 || layer->sprite_group->num_sprites == 0)
+            continue;
+
+        struct aet_layer_state_t *layer_state = &state->layer_states[num_layer_states++];
+        layer_state->layer_index = layer_index;
+        layer_state->sprite_index = batch->sprite_indices[index];
+        layer_state->opacity = batch->opacities[index];
+        layer_state->world_matrix.a = batch->world_a[index];
+        layer_state->world_matrix.b = batch->world_b[index];
+        layer_state->world_matrix.c = batch->world_c[index];
+        layer_state->world_matrix.d = batch->world_d[index];
+        layer_state->world_matrix.tx = batch->world_tx[index];
+        layer_state->world_matrix.ty = batch->world_ty[index];
+    }
+
+    state->frame = batch->frames[instance_index];
+    state->num_layer_states = num_layer_states;
+}
@@ -0,0 +1,127 @@
+//
+//  aet_bind.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "aet_bind.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "allocator.h"
+
+// MARK: - Data Structures
+
+/// The data structure for a single SCR within the name index used while binding.
+struct aet_bind_entry_t
+{
+    /// The name of the SCR.
+    const char *name;
+
+    /// The index of the SPR containing the SCR, within the SPRs being bound to.
+    unsigned int spr_index;
+
+    /// The index of the SCR within it's SPR.
+    unsigned int scr_index;
+};
+
+// MARK: - Functions
+
+/// Compare the two given bind entries by their name, for use with `qsort`.
+///
+/// Entries of equal names are ordered by their SPR, so that earlier SPRs take precedence.
+/// @param a The first entry to compare.
+/// @param b The second entry to compare.
+/// @returns The order of the first entry relative to the second.
+int aet_bind_entry_compare(const void *a, const void *b)
+{
+    const struct aet_bind_entry_t *entry_a = a;
+    const struct aet_bind_entry_t *entry_b = b;
+    int order = strcmp(entry_a->name, entry_b->name);
+    if (order != 0)
+        return order;
+    if (entry_a->spr_index != entry_b->spr_index)
+        return (entry_a->spr_index > entry_b->spr_index) - (entry_a->spr_index < entry_b->spr_index);
+    return (entry_a->scr_index > entry_b->scr_index) - (entry_a->scr_index < entry_b->scr_index);
+}
+
+void aet_composition_bind(const struct aet_composition_t *composition,
+                          unsigned int num_sprs,
+                          const struct spr_t *sprs,
+                          struct aet_binding_t *binding)
+{
+    // index every scr of every spr by name
+    unsigned int num_entries = 0;
+    for (int s = 0; s < num_sprs; s++)
+        num_entries += sprs[s].num_scrs;
+
+    struct aet_bind_entry_t *entries = allocator_malloc(num_entries * sizeof(struct aet_bind_entry_t));
+    unsigned int entry_index = 0;
+    for (int s = 0; s < num_sprs; s++)
+    {
+        for (int i = 0; i < sprs[s].num_scrs; i++)
+        {
+            struct aet_bind_entry_t *entry = &entries[entry_index++];
+            entry->name = sprs[s].scrs[i].name;
+            entry->spr_index = s;
+            entry->scr_index = i;
+        }
+    }
+
+    qsort(entries, num_entries, sizeof(struct aet_bind_entry_t), aet_bind_entry_compare);
+
+    // resolve each scr name to the first entry of the same name
+    binding->composition = composition;
+    binding->num_sprs = num_sprs;
+    binding->sprs = sprs;
+    binding->scr_bindings = allocator_malloc(composition->num_scr_names * sizeof(struct aet_scr_binding_t));
+    binding->num_unresolved = 0;
+    binding->unresolved_indices = allocator_malloc(composition->num_scr_names * sizeof(unsigned int));
+    for (int i = 0; i < composition->num_scr_names; i++)
+    {
+        const char *name = composition->scr_names[i];
+        unsigned int low = 0;
+        unsigned int high = num_entries;
+        while (low < high)
+        {
+            unsigned int middle = low + (high - low) / 2;
+            if (strcmp(entries[middle].name, name) < 0)
+                low = middle + 1;
+            else
+                high = middle;
+        }
+
+        struct aet_scr_binding_t *scr_binding = &binding->scr_bindings[i];
+        if (low < num_entries && strcmp(entries[low].name, name) == 0)
+        {
+            const struct scr_t *scr = &sprs[entries[low].spr_index].scrs[entries[low].scr_index];
+            scr_binding->scr = scr;
+            scr_binding->spr_index = entries[low].spr_index;
+            scr_binding->texture_index = scr->texture_index;
+        }
+        else
+        {
+            scr_binding->scr = NULL;
+            scr_binding->spr_index = 0;
+            scr_binding->texture_index = 0;
+            binding->unresolved_indices[binding->num_unresolved++] = i;
+        }
+    }
+
+    allocator_free(entries);
+}
+
+void aet_binding_destroy(struct aet_binding_t *binding)
+{
+    allocator_free(binding->unresolved_indices);
+    allocator_free(binding->scr_bindings);
+}
+
+const struct aet_scr_binding_t *aet_binding_sprite(const struct aet_binding_t *binding,
+                                                   const struct aet_sprite_t *sprite)
+{
+    return &binding->scr_bindings[sprite->scr_index];
+}
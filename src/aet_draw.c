@@ -0,0 +1,98 @@
+//
+//  aet_draw.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "aet_draw.h"
+
+// MARK: - Constants
+
+/// The maximum number of vertices addressable by the 16-bit indices of a draw list.
+const unsigned int aet_draw_max_indexed_vertices = 65536;
+
+// MARK: - Functions
+
+int aet_draw_list_build(const struct aet_state_t *state,
+                        const struct aet_binding_t *binding,
+                        struct aet_draw_list_t *list)
+{
+    const struct aet_composition_t *composition = state->timeline->composition;
+    unsigned int max_vertices = list->max_vertices;
+    if (max_vertices > aet_draw_max_indexed_vertices)
+        max_vertices = aet_draw_max_indexed_vertices;
+
+    list->num_vertices = 0;
+    list->num_indices = 0;
+    list->num_draw_calls = 0;
+
+    struct aet_draw_call_t *draw_call = NULL;
+    for (int i = 0; i < state->num_layer_states; i++)
+    {
+        const struct aet_layer_state_t *layer_state = &state->layer_states[i];
+        const struct aet_layer_t *layer = &composition->layers[layer_state->layer_index];
+        const struct aet_sprite_group_t *sprite_group = layer->sprite_group;
+        const struct aet_sprite_t *sprite = &sprite_group->sprites[layer_state->sprite_index];
+        const struct aet_scr_binding_t *scr_binding = aet_binding_sprite(binding, sprite);
+        const struct scr_t *scr = scr_binding->scr;
+        if (scr == NULL)
+            continue;
+
+        // begin a new draw call unless this quad can join the previous one
+        int merge = (draw_call != NULL &&
+                     draw_call->spr_index == scr_binding->spr_index &&
+                     draw_call->texture_index == scr_binding->texture_index &&
+                     draw_call->blend_mode == layer->blend_mode);
+
+        if (list->num_vertices + 4 > max_vertices || list->num_indices + 6 > list->max_indices)
+            return 0;
+        if (!merge && list->num_draw_calls >= list->max_draw_calls)
+            return 0;
+
+        if (!merge)
+        {
+            draw_call = &list->draw_calls[list->num_draw_calls++];
+            draw_call->spr_index = scr_binding->spr_index;
+            draw_call->texture_index = scr_binding->texture_index;
+            draw_call->blend_mode = layer->blend_mode;
+            draw_call->first_index = list->num_indices;
+            draw_call->num_indices = 0;
+        }
+
+        // write the corners of the sprite group, top left, top right, bottom left, then bottom right
+        const struct matrix2d_t *m = &layer_state->world_matrix;
+        struct color4_t color = sprite_group->multiply_color;
+        color.a = layer_state->opacity;
+
+        float corners_x[4] = { 0, sprite_group->width, 0, sprite_group->width };
+        float corners_y[4] = { 0, 0, sprite_group->height, sprite_group->height };
+        float corners_u[4] = { scr->start_u, scr->end_u, scr->start_u, scr->end_u };
+        float corners_v[4] = { scr->start_v, scr->start_v, scr->end_v, scr->end_v };
+
+        uint16_t first_vertex = list->num_vertices;
+        for (int c = 0; c < 4; c++)
+        {
+            struct aet_draw_vertex_t *vertex = &list->vertices[list->num_vertices++];
+            vertex->x = (m->a * corners_x[c]) + (m->c * corners_y[c]) + m->tx;
+            vertex->y = (m->b * corners_x[c]) + (m->d * corners_y[c]) + m->ty;
+            vertex->u = corners_u[c];
+            vertex->v = corners_v[c];
+            vertex->color = color;
+        }
+
+        // two triangles covering the quad
+        uint16_t *indices = &list->indices[list->num_indices];
+        indices[0] = first_vertex + 0;
+        indices[1] = first_vertex + 2;
+        indices[2] = first_vertex + 1;
+        indices[3] = first_vertex + 1;
+        indices[4] = first_vertex + 2;
+        indices[5] = first_vertex + 3;
+        list->num_indices += 6;
+        draw_call->num_indices += 6;
+    }
+
+    return 1;
+}
@@ -0,0 +1,116 @@
+//
+//  aet_event.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "aet_event.h"
+
+#include <stdlib.h>
+
+#include "allocator.h"
+
+// MARK: - Functions
+
+/// Compare the two given events by their frame, for use with `qsort`.
+///
+/// Events of equal frames are ordered by their layer, and then by their marker,
+/// so that the order is always stable.
+/// @param a The first event to compare.
+/// @param b The second event to compare.
+/// @returns The order of the first event relative to the second.
+int aet_event_compare(const void *a, const void *b)
+{
+    const struct aet_event_t *event_a = a;
+    const struct aet_event_t *event_b = b;
+    if (event_a->frame != event_b->frame)
+        return (event_a->frame > event_b->frame) - (event_a->frame < event_b->frame);
+    if (event_a->layer_index != event_b->layer_index)
+        return (event_a->layer_index > event_b->layer_index) - (event_a->layer_index < event_b->layer_index);
+    return (event_a->marker > event_b->marker) - (event_a->marker < event_b->marker);
+}
+
+void aet_event_stream_create(const struct aet_timeline_t *timeline, struct aet_event_stream_t *stream)
+{
+    const struct aet_composition_t *composition = timeline->composition;
+
+    // count the markers first to avoid reallocating
+    unsigned int num_events = 0;
+    for (int i = 0; i < composition->num_layers; i++)
+        num_events += composition->layers[i].num_markers;
+
+    stream->events = allocator_malloc(num_events * sizeof(struct aet_event_t));
+
+    // map every marker onto the composition's timeline
+    // this is the inverse of the timeline's mapping from the composition to the layer
+    unsigned int event_index = 0;
+    for (int i = 0; i < composition->num_layers; i++)
+    {
+        const struct aet_layer_t *layer = &composition->layers[i];
+        float frame_scale = timeline->frame_scales[i];
+        float frame_offset = timeline->frame_offsets[i];
+        if (frame_scale == 0)
+            continue;
+
+        for (int m = 0; m < layer->num_markers; m++)
+        {
+            const struct aet_marker_t *marker = &layer->markers[m];
+            struct aet_event_t *event = &stream->events[event_index++];
+            event->frame = (marker->frame - frame_offset) / frame_scale;
+            event->layer_index = i;
+            event->marker = marker;
+        }
+    }
+
+    qsort(stream->events, event_index, sizeof(struct aet_event_t), aet_event_compare);
+    stream->num_events = event_index;
+}
+
+void aet_event_stream_destroy(struct aet_event_stream_t *stream)
+{
+    allocator_free(stream->events);
+}
+
+void aet_event_cursor_seek(const struct aet_event_stream_t *stream, float frame, struct aet_event_cursor_t *cursor)
+{
+    // find the number of events at or before the frame
+    unsigned int low = 0;
+    unsigned int high = stream->num_events;
+    while (low < high)
+    {
+        unsigned int middle = low + (high - low) / 2;
+        if (stream->events[middle].frame <= frame)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    cursor->stream = stream;
+    cursor->frame = frame;
+    cursor->position = low;
+}
+
+const struct aet_event_t *aet_event_cursor_advance(struct aet_event_cursor_t *cursor,
+                                                   float frame,
+                                                   unsigned int *num_events)
+{
+    const struct aet_event_stream_t *stream = cursor->stream;
+    if (frame < cursor->frame)
+    {
+        aet_event_cursor_seek(stream, frame, cursor);
+        *num_events = 0;
+        return &stream->events[cursor->position];
+    }
+
+    unsigned int first = cursor->position;
+    unsigned int position = first;
+    while (position < stream->num_events && stream->events[position].frame <= frame)
+        position++;
+
+    cursor->frame = frame;
+    cursor->position = position;
+    *num_events = position - first;
+    return &stream->events[first];
+}
@@ -0,0 +1,308 @@
+//
+//  aet_player.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "aet_player.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#include "allocator.h"
+
+// MARK: - Functions
+
+/// Set the given boundary of the given range, if it has not already been set.
+/// @param range The range to set the boundary of.
+/// @param is_start Whether the boundary is the start of the range, otherwise the end.
+/// @param frame The frame number of the boundary.
+/// @param start_found Whether the start of the given range has been set, modified when it is.
+/// @param end_found Whether the end of the given range has been set, modified when it is.
+void aet_marker_range_set(struct aet_marker_range_t *range,
+                          int is_start,
+                          float frame,
+                          int *start_found,
+                          int *end_found)
+{
+    if (is_start && !*start_found)
+    {
+        range->start_frame = frame;
+        *start_found = 1;
+    }
+    else if (!is_start && !*end_found)
+    {
+        range->end_frame = frame;
+        *end_found = 1;
+    }
+
+    range->exists = 1;
+}
+
+/// Add the given markers to the given ranges, skipping any boundary that is already set.
+/// @param num_markers The total number of markers within the given array.
+/// @param markers The markers to add.
+/// @param frame_scale The scale to map the given markers' frames through.
+/// @param frame_offset The offset to map the given markers' frames through, after scaling.
+/// @param ranges The ranges to add the given markers to.
+/// @param found Whether the start and end of each range has been set, in the order of the marker types.
+void aet_marker_ranges_add(unsigned int num_markers,
+                           const struct aet_marker_t *markers,
+                           float frame_scale,
+                           float frame_offset,
+                           struct aet_marker_ranges_t *ranges,
+                           int *found)
+{
+    for (int i = 0; i < num_markers; i++)
+    {
+        const struct aet_marker_t *marker = &markers[i];
+        float frame = (marker->frame * frame_scale) + frame_offset;
+        switch (marker->type)
+        {
+            case AET_MARKER_TYPE_IN_START:
+            case AET_MARKER_TYPE_IN_END:
+                aet_marker_range_set(&ranges->in, marker->type == AET_MARKER_TYPE_IN_START, frame, &found[0], &found[1]);
+                break;
+            case AET_MARKER_TYPE_LOOP_START:
+            case AET_MARKER_TYPE_LOOP_END:
+                aet_marker_range_set(&ranges->loop, marker->type == AET_MARKER_TYPE_LOOP_START, frame, &found[2], &found[3]);
+                break;
+            case AET_MARKER_TYPE_OUT_START:
+            case AET_MARKER_TYPE_OUT_END:
+                aet_marker_range_set(&ranges->out, marker->type == AET_MARKER_TYPE_OUT_START, frame, &found[4], &found[5]);
+                break;
+            case AET_MARKER_TYPE_PRESS_START:
+            case AET_MARKER_TYPE_PRESS_END:
+                aet_marker_range_set(&ranges->press, marker->type == AET_MARKER_TYPE_PRESS_START, frame, &found[6], &found[7]);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/// Reset the given ranges to all not existing, spanning the given timeline bounds.
+/// @param start_frame The first frame number of the timeline containing the ranges.
+/// @param end_frame The last frame number of the timeline containing the ranges.
+/// @param ranges The ranges to reset.
+void aet_marker_ranges_reset(float start_frame, float end_frame, struct aet_marker_ranges_t *ranges)
+{
+    struct aet_marker_range_t empty = { 0, start_frame, end_frame };
+    ranges->in = empty;
+    ranges->loop = empty;
+    ranges->out = empty;
+    ranges->press = empty;
+}
+
+void aet_marker_ranges_read(unsigned int num_markers,
+                            const struct aet_marker_t *markers,
+                            float start_frame,
+                            float end_frame,
+                            struct aet_marker_ranges_t *ranges)
+{
+    int found[8] = { 0 };
+    aet_marker_ranges_reset(start_frame, end_frame, ranges);
+    aet_marker_ranges_add(num_markers, markers, 1, 0, ranges, found);
+}
+
+void aet_marker_table_create(const struct aet_timeline_t *timeline, struct aet_marker_table_t *table)
+{
+    const struct aet_composition_t *composition = timeline->composition;
+    table->num_layers = timeline->num_layers;
+    table->layer_ranges = allocator_malloc(timeline->num_layers * sizeof(struct aet_marker_ranges_t));
+
+    int composition_found[8] = { 0 };
+    aet_marker_ranges_reset(composition->timeline_start_frame,
+                            composition->timeline_end_frame,
+                            &table->composition_ranges);
+
+    for (int i = 0; i < timeline->num_layers; i++)
+    {
+        const struct aet_layer_t *layer = &composition->layers[i];
+
+        // layer markers are within the layer's own timeline,
+        // which begins at zero and lasts for the layer's duration at its speed
+        float layer_end_frame = (layer->timeline_end_frame - layer->timeline_start_frame) * layer->timeline_speed;
+        aet_marker_ranges_read(layer->num_markers, layer->markers, 0, layer_end_frame, &table->layer_ranges[i]);
+
+        // map the markers back onto the composition's timeline
+        // the inverse of the timeline's mapping from the composition to the layer
+        float frame_scale = timeline->frame_scales[i];
+        if (layer->num_markers == 0 || frame_scale == 0)
+            continue;
+
+        aet_marker_ranges_add(layer->num_markers,
+                              layer->markers,
+                              1 / frame_scale,
+                              -timeline->frame_offsets[i] / frame_scale,
+                              &table->composition_ranges,
+                              composition_found);
+    }
+}
+
+void aet_marker_table_destroy(struct aet_marker_table_t *table)
+{
+    allocator_free(table->layer_ranges);
+}
+
+/// Begin playing the given state of the given player, from the given frame.
+/// @param player The player to change the state of.
+/// @param state The state to begin playing.
+/// @param start_frame The frame number at which the state begins playing.
+void aet_player_state_begin(struct aet_player_t *player, enum aet_player_state_t state, double start_frame)
+{
+    player->state = state;
+    player->state_start_frame = start_frame;
+    player->state_steps = 0;
+}
+
+void aet_player_create(const struct aet_marker_ranges_t *ranges, double frame_step, struct aet_player_t *player)
+{
+    player->ranges = *ranges;
+    player->frame_step = frame_step;
+    player->out_requested = 0;
+    player->press_requested = 0;
+
+    // begin with the in transition, falling back to the loop
+    if (ranges->in.exists || !ranges->loop.exists)
+        aet_player_state_begin(player, AET_PLAYER_STATE_IN, ranges->in.start_frame);
+    else
+        aet_player_state_begin(player, AET_PLAYER_STATE_LOOP, ranges->loop.start_frame);
+
+    player->frame = (float)player->state_start_frame;
+}
+
+/// Get the range that the given state of the given player plays through.
+/// @param player The player to get the range from.
+/// @param state The state to get the range of.
+/// @returns The range of the given state.
+const struct aet_marker_range_t *aet_player_state_range(const struct aet_player_t *player,
+                                                        enum aet_player_state_t state)
+{
+    switch (state)
+    {
+        case AET_PLAYER_STATE_IN:    return &player->ranges.in;
+        case AET_PLAYER_STATE_LOOP:  return &player->ranges.loop;
+        case AET_PLAYER_STATE_PRESS: return &player->ranges.press;
+        case AET_PLAYER_STATE_OUT:   return &player->ranges.out;
+        case AET_PLAYER_STATE_DONE:  return &player->ranges.out;
+    }
+
+    return NULL;
+}
+
+float aet_player_step(struct aet_player_t *player)
+{
+    player->state_steps++;
+
+    // any state change within a step carries the excess frames over into the next state,
+    // so playback timing is unaffected by where within a step the change lands
+    // this only ever loops once per state, so it is still constant time
+    double frame;
+    while (1)
+    {
+        const struct aet_marker_range_t *range = aet_player_state_range(player, player->state);
+        double elapsed = (double)player->state_steps * player->frame_step;
+        frame = player->state_start_frame + elapsed;
+
+        switch (player->state)
+        {
+            case AET_PLAYER_STATE_IN:
+            case AET_PLAYER_STATE_PRESS:
+            {
+                if (frame < range->end_frame)
+                    break;
+
+                // go to the out transition or press animation if either was requested while this was playing,
+                // otherwise to the loop, holding at the end of this range if there is no loop
+                // the request is cleared before the press begins, so this still only loops once more
+                double excess = frame - range->end_frame;
+                if (player->out_requested && player->ranges.out.exists)
+                    aet_player_state_begin(player, AET_PLAYER_STATE_OUT, player->ranges.out.start_frame + excess);
+                else if (player->out_requested)
+                    aet_player_state_begin(player, AET_PLAYER_STATE_DONE, range->end_frame);
+                else if (player->press_requested)
+                {
+                    player->press_requested = 0;
+                    aet_player_state_begin(player, AET_PLAYER_STATE_PRESS, player->ranges.press.start_frame + excess);
+                }
+                else if (player->ranges.loop.exists)
+                    aet_player_state_begin(player, AET_PLAYER_STATE_LOOP, player->ranges.loop.start_frame + excess);
+                else
+                    aet_player_state_begin(player, AET_PLAYER_STATE_LOOP, range->end_frame);
+
+                continue;
+            }
+            case AET_PLAYER_STATE_LOOP:
+            {
+                // wrap from the steps since the loop began rather than the previous frame,
+                // so the position is exact no matter how many times it has looped
+                double length = range->end_frame - range->start_frame;
+                if (!range->exists || length <= 0)
+                    frame = player->state_start_frame;
+                else
+                    frame = range->start_frame + fmod((player->state_start_frame - range->start_frame) + elapsed, length);
+                break;
+            }
+            case AET_PLAYER_STATE_OUT:
+            {
+                if (frame < range->end_frame)
+                    break;
+
+                aet_player_state_begin(player, AET_PLAYER_STATE_DONE, range->end_frame);
+                continue;
+            }
+            case AET_PLAYER_STATE_DONE:
+            {
+                frame = player->state_start_frame;
+                break;
+            }
+        }
+
+        break;
+    }
+
+    player->frame = (float)frame;
+    return player->frame;
+}
+
+void aet_player_press(struct aet_player_t *player)
+{
+    if (!player->ranges.press.exists || player->out_requested)
+        return;
+
+    switch (player->state)
+    {
+        case AET_PLAYER_STATE_LOOP:
+            // begin on the next step, so the press frame itself is the current loop frame
+            aet_player_state_begin(player, AET_PLAYER_STATE_PRESS, player->ranges.press.start_frame - player->frame_step);
+            break;
+        case AET_PLAYER_STATE_IN:
+        case AET_PLAYER_STATE_PRESS:
+            player->press_requested = 1;
+            break;
+        default:
+            break;
+    }
+}
+
+void aet_player_out(struct aet_player_t *player)
+{
+    switch (player->state)
+    {
+        case AET_PLAYER_STATE_LOOP:
+            if (player->ranges.out.exists)
+                aet_player_state_begin(player, AET_PLAYER_STATE_OUT, player->ranges.out.start_frame - player->frame_step);
+            else
+                aet_player_state_begin(player, AET_PLAYER_STATE_DONE, player->frame);
+            break;
+        case AET_PLAYER_STATE_IN:
+        case AET_PLAYER_STATE_PRESS:
+            player->out_requested = 1;
+            break;
+        default:
+            break;
+    }
+}
@@ -0,0 +1,869 @@
+//
+//  aet_render.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "aet_render.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "allocator.h"
+#include "aet_state.h"
+#include "matrix.h"
+
+// MARK: - Constants
+
+/// The width and height of each tile that binned rendering splits the render target into, in pixels.
+const int aet_render_tile_size = 64;
+
+// MARK: - Data Structures
+
+/// The data structure for a single sprite ready to be drawn into a render target.
+struct aet_render_quad_t
+{
+    /// The matrix transforming the pixel space of the render target into the pixel space of the sprite group.
+    struct matrix2d_t inverse_matrix;
+
+    /// The width of the sprite group, in pixels.
+    float width;
+
+    /// The height of the sprite group, in pixels.
+    float height;
+
+    /// The index of the texture containing the sprite's SCR, within the render's textures.
+    unsigned int texture_index;
+
+    /// The unpacked texture containing the sprite's SCR.
+    ///
+    /// This is only set once the render's textures have been acquired.
+    const uint8_t *texels;
+
+    /// The width of the texture containing the sprite's SCR, in pixels.
+    unsigned int texture_width;
+
+    /// The bounds of the sprite's SCR within it's texture, in pixels.
+    unsigned int scr_x, scr_y, scr_width, scr_height;
+
+    /// The factors to multiply the premultiplied red, green, blue, and alpha channels of each texel by.
+    ///
+    /// These combine the sprite group's multiply colour and the layer's opacity, out of `255`.
+    unsigned int tint[4];
+
+    /// The blend mode to draw the sprite with.
+    enum aet_layer_blend_mode_t blend_mode;
+
+    /// The bounding box of the sprite within the render target, in pixels.
+    ///
+    /// The minimums are inclusive and the maximums are exclusive.
+    int min_x, min_y, max_x, max_y;
+};
+
+/// The data structure for the textures used by a single render, pinned within a texture cache until the render finishes.
+struct aet_render_textures_t
+{
+    /// The binding whose SPRs contain the textures.
+    const struct aet_binding_t *binding;
+
+    /// The texture cache that the textures are acquired from.
+    struct texture_cache_t *cache;
+
+    /// The offset of the first texture of each of the binding's SPRs, within `entries`.
+    ///
+    /// Allocated.
+    unsigned int *offsets;
+
+    /// The pinned entry of each texture of every one of the binding's SPRs, or `NULL` if it has not been acquired.
+    ///
+    /// Allocated.
+    struct texture_cache_entry_t **entries;
+
+    /// The total number of textures that the render uses.
+    unsigned int num_used;
+
+    /// The index of each texture that the render uses, within `entries`, in the order that they are first used.
+    ///
+    /// Allocated.
+    unsigned int *used_indices;
+
+    /// Whether or not each texture is used by the render, in the same order as `entries`.
+    ///
+    /// Allocated.
+    uint8_t *used;
+
+    /// The index of the next item of `used_indices` to acquire, shared by every thread acquiring the textures.
+    atomic_uint next_acquire;
+};
+
+/// The data structure for the quads of a frame, binned into the tiles of a render target.
+struct aet_render_bins_t
+{
+    /// The render target that the tiles are within.
+    uint8_t *target;
+
+    /// The number of bytes between the beginning of each row within the render target.
+    size_t stride;
+
+    /// The width of the render target, in pixels.
+    int width;
+
+    /// The height of the render target, in pixels.
+    int height;
+
+    /// The number of columns of tiles within the render target.
+    int num_columns;
+
+    /// The number of rows of tiles within the render target.
+    int num_rows;
+
+    /// All the quads of the frame, ordered back to front.
+    const struct aet_render_quad_t *quads;
+
+    /// The offset of each tile's bin within `quad_indices`, ordered left to right and then top to bottom.
+    ///
+    /// There is one more item than there are tiles, so that the end of each bin is the offset of the next.
+    /// Allocated.
+    uint32_t *offsets;
+
+    /// The indices of the quads within each tile's bin, within `quads`.
+    ///
+    /// The indices within each bin are ordered back to front.
+    /// Allocated.
+    uint32_t *quad_indices;
+};
+
+/// The data structure for a single thread of a binned render, and the queue of tiles that it owns.
+struct aet_render_worker_t
+{
+    /// The bins being rendered.
+    const struct aet_render_bins_t *bins;
+
+    /// The index of this worker, within the array of all the render's workers.
+    unsigned int index;
+
+    /// The total number of workers within the render.
+    unsigned int num_workers;
+
+    /// The index of the next tile within this worker's queue.
+    unsigned int first_tile;
+
+    /// The index after the last tile within this worker's queue.
+    unsigned int end_tile;
+
+    /// The mutex guarding `first_tile` and `end_tile`, which other workers modify when stealing.
+    pthread_mutex_t mutex;
+};
+
+// MARK: - Functions
+
+/// Divide the given value by 255, rounding to the nearest integer.
+///
+/// This is exact for all products of two 8-bit values, and is mirrored by the vectorized span blending.
+/// @param value The value to divide, at most `255 * 255`.
+/// @returns The given value divided by 255.
+unsigned int aet_render_div255(unsigned int value)
+{
+    value += 128;
+    return (value + (value >> 8)) >> 8;
+}
+
+/// Blend the given span of source pixels onto the given span of destination pixels.
+///
+/// Both spans are premultiplied 8-bit red, green, blue, and alpha pixels.
+/// Normal blending is `source + destination * (1 - source alpha)`,
+/// while additive blending adds the colour channels and blends the alpha channel normally.
+/// @param destination The pixels to blend onto.
+/// @param source The pixels to blend.
+/// @param num_pixels The number of pixels within both spans.
+/// @param blend_mode The blend mode to blend the spans with.
+void aet_render_span_blend(uint8_t *destination,
+                           const uint8_t *source,
+                           unsigned int num_pixels,
+                           enum aet_layer_blend_mode_t blend_mode)
+{
+    int add = (blend_mode == AET_LAYER_BLEND_MODE_ADD);
+    unsigned int i = 0;
+
+#if defined(__SSE2__)
+    // four pixels at a time, widened to two sets of 16-bit lanes
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(128);
+    const __m128i alpha_mask = _mm_set1_epi32((int)0xff000000);
+    for (; i + 4 <= num_pixels; i += 4)
+    {
+        __m128i s = _mm_loadu_si128((const __m128i *)(source + (i * 4)));
+        __m128i d = _mm_loadu_si128((const __m128i *)(destination + (i * 4)));
+
+        // broadcast the inverse source alpha to every channel of its pixel
+        __m128i inverse_alpha = _mm_srli_epi32(s, 24);
+        inverse_alpha = _mm_or_si128(inverse_alpha, _mm_slli_epi32(inverse_alpha, 8));
+        inverse_alpha = _mm_or_si128(inverse_alpha, _mm_slli_epi32(inverse_alpha, 16));
+        inverse_alpha = _mm_xor_si128(inverse_alpha, _mm_set1_epi8((char)0xff));
+
+        __m128i low = _mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(inverse_alpha, zero));
+        __m128i high = _mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(inverse_alpha, zero));
+        low = _mm_add_epi16(low, round);
+        high = _mm_add_epi16(high, round);
+        low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+        high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+
+        __m128i result = _mm_adds_epu8(s, _mm_packus_epi16(low, high));
+        if (add)
+        {
+            __m128i sum = _mm_adds_epu8(d, s);
+            result = _mm_or_si128(_mm_andnot_si128(alpha_mask, sum), _mm_and_si128(alpha_mask, result));
+        }
+
+        _mm_storeu_si128((__m128i *)(destination + (i * 4)), result);
+    }
+#elif defined(__ARM_NEON)
+    // four pixels at a time, widened to two sets of 16-bit lanes
+    const uint8x16_t alpha_mask = vreinterpretq_u8_u32(vdupq_n_u32(0xff000000));
+    for (; i + 4 <= num_pixels; i += 4)
+    {
+        uint8x16_t s = vld1q_u8(source + (i * 4));
+        uint8x16_t d = vld1q_u8(destination + (i * 4));
+
+        // broadcast the inverse source alpha to every channel of its pixel
+        uint32x4_t alpha = vshrq_n_u32(vreinterpretq_u32_u8(s), 24);
+        alpha = vorrq_u32(alpha, vshlq_n_u32(alpha, 8));
+        alpha = vorrq_u32(alpha, vshlq_n_u32(alpha, 16));
+        uint8x16_t inverse_alpha = vmvnq_u8(vreinterpretq_u8_u32(alpha));
+
+        uint16x8_t low = vmull_u8(vget_low_u8(d), vget_low_u8(inverse_alpha));
+        uint16x8_t high = vmull_u8(vget_high_u8(d), vget_high_u8(inverse_alpha));
+        low = vaddq_u16(low, vdupq_n_u16(128));
+        high = vaddq_u16(high, vdupq_n_u16(128));
+        uint8x8_t low_scaled = vshrn_n_u16(vsraq_n_u16(low, low, 8), 8);
+        uint8x8_t high_scaled = vshrn_n_u16(vsraq_n_u16(high, high, 8), 8);
+
+        uint8x16_t result = vqaddq_u8(s, vcombine_u8(low_scaled, high_scaled));
+        if (add)
+            result = vbslq_u8(alpha_mask, result, vqaddq_u8(d, s));
+
+        vst1q_u8(destination + (i * 4), result);
+    }
+#endif
+
+    // the remaining pixels, or all of them without vector support
+    for (; i < num_pixels; i++)
+    {
+        const uint8_t *s = source + (i * 4);
+        uint8_t *d = destination + (i * 4);
+        unsigned int inverse_alpha = 255 - s[3];
+        for (int c = 0; c < 4; c++)
+        {
+            unsigned int value;
+            if (add && c < 3)
+                value = d[c] + s[c];
+            else
+                value = s[c] + aet_render_div255(d[c] * inverse_alpha);
+
+            d[c] = (value > 255) ? 255 : value;
+        }
+    }
+}
+
+/// Sample the texture of the given quad at the given point, with bilinear filtering.
+///
+/// Texels outside of the quad's SCR are never sampled, the edges are clamped instead.
+/// @param quad The quad to sample the texture of.
+/// @param u The horizontal position within the texture to sample at, in texels.
+/// @param v The vertical position within the texture to sample at, in texels.
+/// @param pixel The premultiplied 8-bit red, green, blue, and alpha pixel to write the sample to.
+void aet_render_quad_sample(const struct aet_render_quad_t *quad, float u, float v, uint8_t *pixel)
+{
+    // sample between texel centers
+    u -= 0.5f;
+    v -= 0.5f;
+
+    float u_floor = floorf(u);
+    float v_floor = floorf(v);
+    unsigned int weight_x = (unsigned int)((u - u_floor) * 256);
+    unsigned int weight_y = (unsigned int)((v - v_floor) * 256);
+
+    int min_x = quad->scr_x, max_x = quad->scr_x + quad->scr_width - 1;
+    int min_y = quad->scr_y, max_y = quad->scr_y + quad->scr_height - 1;
+    int x0 = (int)u_floor, x1 = x0 + 1;
+    int y0 = (int)v_floor, y1 = y0 + 1;
+    x0 = (x0 < min_x) ? min_x : (x0 > max_x) ? max_x : x0;
+    x1 = (x1 < min_x) ? min_x : (x1 > max_x) ? max_x : x1;
+    y0 = (y0 < min_y) ? min_y : (y0 > max_y) ? max_y : y0;
+    y1 = (y1 < min_y) ? min_y : (y1 > max_y) ? max_y : y1;
+
+    const uint8_t *texels[4] =
+    {
+        quad->texels + (((y0 * quad->texture_width) + x0) * 4),
+        quad->texels + (((y0 * quad->texture_width) + x1) * 4),
+        quad->texels + (((y1 * quad->texture_width) + x0) * 4),
+        quad->texels + (((y1 * quad->texture_width) + x1) * 4),
+    };
+
+    unsigned int weights[4] =
+    {
+        (256 - weight_x) * (256 - weight_y),
+        weight_x * (256 - weight_y),
+        (256 - weight_x) * weight_y,
+        weight_x * weight_y,
+    };
+
+    // filter in premultiplied space so transparent texels do not bleed their colour
+    unsigned int sum[4] = { 0, 0, 0, 0 };
+    for (int t = 0; t < 4; t++)
+    {
+        unsigned int alpha = texels[t][3];
+        sum[0] += aet_render_div255(texels[t][0] * alpha) * weights[t];
+        sum[1] += aet_render_div255(texels[t][1] * alpha) * weights[t];
+        sum[2] += aet_render_div255(texels[t][2] * alpha) * weights[t];
+        sum[3] += alpha * weights[t];
+    }
+
+    for (int c = 0; c < 4; c++)
+        pixel[c] = aet_render_div255(((sum[c] + 32768) >> 16) * quad->tint[c]);
+}
+
+/// Get the range of pixels along the given row where the given quad's sprite group space coordinate is within bounds.
+/// @param origin The sprite group space coordinate at the center of the row's first pixel.
+/// @param step The change in the sprite group space coordinate per pixel along the row.
+/// @param size The size of the sprite group along the coordinate's axis.
+/// @param start The first pixel within range, modified to be no lower than the range of the coordinate.
+/// @param end The pixel after the last within range, modified to be no higher than the range of the coordinate.
+void aet_render_span_clip(float origin, float step, float size, float *start, float *end)
+{
+    if (step == 0)
+    {
+        if (origin < 0 || origin >= size)
+            *end = *start;
+        return;
+    }
+
+    float first = -origin / step;
+    float last = (size - origin) / step;
+    if (step < 0)
+    {
+        float swap = first;
+        first = last;
+        last = swap;
+    }
+
+    if (first > *start)
+        *start = first;
+    if (last < *end)
+        *end = last;
+}
+
+/// Draw the given quad into the given render target, within the given clipping bounds.
+/// @param quad The quad to draw.
+/// @param target The render target to draw into, of premultiplied 8-bit red, green, blue, and alpha pixels.
+/// @param stride The number of bytes between the beginning of each row within the given render target.
+/// @param clip_min_x The left edge of the clipping bounds, inclusive.
+/// @param clip_min_y The top edge of the clipping bounds, inclusive.
+/// @param clip_max_x The right edge of the clipping bounds, exclusive.
+/// @param clip_max_y The bottom edge of the clipping bounds, exclusive.
+/// @param span Scratch storage for a row of source pixels, with room for at least the clipping bounds' width.
+void aet_render_quad_draw(const struct aet_render_quad_t *quad,
+                          uint8_t *target,
+                          size_t stride,
+                          int clip_min_x,
+                          int clip_min_y,
+                          int clip_max_x,
+                          int clip_max_y,
+                          uint8_t *span)
+{
+    int min_x = (quad->min_x > clip_min_x) ? quad->min_x : clip_min_x;
+    int min_y = (quad->min_y > clip_min_y) ? quad->min_y : clip_min_y;
+    int max_x = (quad->max_x < clip_max_x) ? quad->max_x : clip_max_x;
+    int max_y = (quad->max_y < clip_max_y) ? quad->max_y : clip_max_y;
+
+    const struct matrix2d_t *inverse = &quad->inverse_matrix;
+    float u_scale = (float)quad->scr_width / quad->width;
+    float v_scale = (float)quad->scr_height / quad->height;
+    for (int y = min_y; y < max_y; y++)
+    {
+        // get the sprite group space coordinates at the center of the first pixel of the row,
+        // then clip the row to where they are within the sprite group
+        float center_y = y + 0.5f;
+        float origin_x = (inverse->a * 0.5f) + (inverse->c * center_y) + inverse->tx;
+        float origin_y = (inverse->b * 0.5f) + (inverse->d * center_y) + inverse->ty;
+
+        float start = min_x, end = max_x;
+        aet_render_span_clip(origin_x, inverse->a, quad->width, &start, &end);
+        aet_render_span_clip(origin_y, inverse->b, quad->height, &start, &end);
+
+        int span_start = (int)ceilf(start);
+        int span_end = (int)ceilf(end);
+        if (span_start < min_x)
+            span_start = min_x;
+        if (span_end > max_x)
+            span_end = max_x;
+        if (span_start >= span_end)
+            continue;
+
+        // fill the span with the source pixels, then blend it all at once
+        for (int x = span_start; x < span_end; x++)
+        {
+            float sprite_x = origin_x + (inverse->a * x);
+            float sprite_y = origin_y + (inverse->b * x);
+            aet_render_quad_sample(quad,
+                                   quad->scr_x + (sprite_x * u_scale),
+                                   quad->scr_y + (sprite_y * v_scale),
+                                   span + ((x - span_start) * 4));
+        }
+
+        aet_render_span_blend(target + (y * stride) + (span_start * 4),
+                              span,
+                              span_end - span_start,
+                              quad->blend_mode);
+    }
+}
+
+/// Create the textures of a render, with none used yet.
+/// @param binding The binding whose SPRs contain the textures.
+/// @param cache The texture cache to acquire the textures from.
+/// @param textures The textures to create.
+void aet_render_textures_create(const struct aet_binding_t *binding,
+                                struct texture_cache_t *cache,
+                                struct aet_render_textures_t *textures)
+{
+    textures->binding = binding;
+    textures->cache = cache;
+    textures->offsets = allocator_malloc(binding->num_sprs * sizeof(unsigned int));
+
+    unsigned int num_textures = 0;
+    for (unsigned int i = 0; i < binding->num_sprs; i++)
+    {
+        textures->offsets[i] = num_textures;
+        num_textures += binding->sprs[i].num_textures;
+    }
+
+    textures->entries = allocator_calloc(num_textures, sizeof(struct texture_cache_entry_t *));
+    textures->num_used = 0;
+    textures->used_indices = allocator_malloc(num_textures * sizeof(unsigned int));
+    textures->used = allocator_calloc(num_textures, sizeof(uint8_t));
+    atomic_init(&textures->next_acquire, 0);
+}
+
+/// Destroy the given textures of a render, releasing every acquired texture and all of it's allocated memory.
+/// @param textures The textures to destroy.
+void aet_render_textures_destroy(struct aet_render_textures_t *textures)
+{
+    for (unsigned int i = 0; i < textures->num_used; i++)
+    {
+        struct texture_cache_entry_t *entry = textures->entries[textures->used_indices[i]];
+        if (entry != NULL)
+            texture_cache_release(textures->cache, entry);
+    }
+
+    allocator_free(textures->used);
+    allocator_free(textures->used_indices);
+    allocator_free(textures->entries);
+    allocator_free(textures->offsets);
+}
+
+/// Mark the given texture as used by the given render.
+/// @param textures The textures of the render.
+/// @param spr_index The index of the SPR containing the texture, within the render's binding.
+/// @param texture_index The index of the texture, within the SPR at the given index.
+/// @returns The index of the texture within the render's textures.
+unsigned int aet_render_textures_use(struct aet_render_textures_t *textures,
+                                     unsigned int spr_index,
+                                     unsigned int texture_index)
+{
+    unsigned int index = textures->offsets[spr_index] + texture_index;
+    if (!textures->used[index])
+    {
+        textures->used[index] = 1;
+        textures->used_indices[textures->num_used++] = index;
+    }
+
+    return index;
+}
+
+/// Acquire textures used by a render until every one of them has been acquired.
+///
+/// This can be run on multiple threads at once, with each thread taking the next texture that is not yet taken,
+/// so that textures are decoded in parallel.
+/// @param argument The textures of the render, as a `struct aet_render_textures_t *`.
+/// @returns `NULL`, for use with `pthread_create`.
+void *aet_render_textures_acquire(void *argument)
+{
+    struct aet_render_textures_t *textures = argument;
+    const struct aet_binding_t *binding = textures->binding;
+
+    unsigned int used_index;
+    while ((used_index = atomic_fetch_add(&textures->next_acquire, 1)) < textures->num_used)
+    {
+        // find the spr containing the texture
+        unsigned int index = textures->used_indices[used_index];
+        unsigned int spr_index = binding->num_sprs - 1;
+        while (textures->offsets[spr_index] > index)
+            spr_index--;
+
+        const struct spr_t *spr = &binding->sprs[spr_index];
+        const struct ctr_texture_t *texture = &spr->textures[index - textures->offsets[spr_index]];
+        textures->entries[index] = texture_cache_acquire(textures->cache,
+                                                         spr,
+                                                         spr->file,
+                                                         texture,
+                                                         TEXTURE_CACHE_OUTPUT_UNPACKED);
+    }
+
+    return NULL;
+}
+
+/// Run the given function once for each of the given arguments, in parallel.
+///
+/// The first argument is run on the calling thread, and each of the others on it's own thread.
+/// If a thread cannot be created, then it's argument is run on the calling thread instead,
+/// so the given function must finish correctly regardless of how many threads are running it.
+/// @param function The function to run.
+/// @param arguments The argument to pass to each run of the given function.
+/// @param num_arguments The total number of arguments within the given array.
+void aet_render_parallel(void *(*function)(void *), void **arguments, unsigned int num_arguments)
+{
+    pthread_t *threads = allocator_malloc(num_arguments * sizeof(pthread_t));
+    int *started = allocator_malloc(num_arguments * sizeof(int));
+    for (unsigned int t = 1; t < num_arguments; t++)
+        started[t] = (pthread_create(&threads[t], NULL, function, arguments[t]) == 0);
+
+    function(arguments[0]);
+
+    for (unsigned int t = 1; t < num_arguments; t++)
+        if (!started[t])
+            function(arguments[t]);
+
+    for (unsigned int t = 1; t < num_arguments; t++)
+        if (started[t])
+            pthread_join(threads[t], NULL);
+
+    allocator_free(started);
+    allocator_free(threads);
+}
+
+/// Prepare the quad for the given layer state.
+///
+/// The texture of the quad is only marked as used, it's texels are set once the render's textures are acquired.
+/// @param composition The composition containing the layer of the given state.
+/// @param layer_state The evaluated state of the layer to prepare the quad of.
+/// @param binding The binding of the given composition.
+/// @param textures The textures of the render, to mark the quad's texture as used within.
+/// @param target_width The width of the render target, in pixels.
+/// @param target_height The height of the render target, in pixels.
+/// @param quad The quad to prepare.
+/// @returns Whether or not the quad has anything to draw.
+int aet_render_quad_prepare(const struct aet_composition_t *composition,
+                            const struct aet_layer_state_t *layer_state,
+                            const struct aet_binding_t *binding,
+                            struct aet_render_textures_t *textures,
+                            int target_width,
+                            int target_height,
+                            struct aet_render_quad_t *quad)
+{
+    const struct aet_layer_t *layer = &composition->layers[layer_state->layer_index];
+    const struct aet_sprite_group_t *sprite_group = layer->sprite_group;
+    const struct aet_sprite_t *sprite = &sprite_group->sprites[layer_state->sprite_index];
+
+    // resolve the scr
+    const struct aet_scr_binding_t *scr_binding = aet_binding_sprite(binding, sprite);
+    const struct scr_t *scr = scr_binding->scr;
+    if (scr == NULL || scr->width == 0 || scr->height == 0)
+        return 0;
+    if (sprite_group->width == 0 || sprite_group->height == 0)
+        return 0;
+    if (!matrix2d_invert(layer_state->world_matrix, &quad->inverse_matrix))
+        return 0;
+
+    // get the bounds of the transformed sprite group
+    const struct matrix2d_t *m = &layer_state->world_matrix;
+    float corners_x[4] = { 0, sprite_group->width, 0, sprite_group->width };
+    float corners_y[4] = { 0, 0, sprite_group->height, sprite_group->height };
+    float min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+    for (int i = 0; i < 4; i++)
+    {
+        float x = (m->a * corners_x[i]) + (m->c * corners_y[i]) + m->tx;
+        float y = (m->b * corners_x[i]) + (m->d * corners_y[i]) + m->ty;
+        min_x = fminf(min_x, x);
+        min_y = fminf(min_y, y);
+        max_x = fmaxf(max_x, x);
+        max_y = fmaxf(max_y, y);
+    }
+
+    quad->min_x = (int)fmaxf(floorf(min_x), 0);
+    quad->min_y = (int)fmaxf(floorf(min_y), 0);
+    quad->max_x = (int)fminf(ceilf(max_x), target_width);
+    quad->max_y = (int)fminf(ceilf(max_y), target_height);
+    if (quad->min_x >= quad->max_x || quad->min_y >= quad->max_y)
+        return 0;
+
+    const struct spr_t *spr = &binding->sprs[scr_binding->spr_index];
+    const struct ctr_texture_t *texture = &spr->textures[scr_binding->texture_index];
+
+    float opacity = fminf(layer_state->opacity, 1);
+    quad->width = sprite_group->width;
+    quad->height = sprite_group->height;
+    quad->texture_index = aet_render_textures_use(textures, scr_binding->spr_index, scr_binding->texture_index);
+    quad->texels = NULL;
+    quad->texture_width = texture->width;
+    quad->scr_x = scr->x;
+    quad->scr_y = scr->y;
+    quad->scr_width = scr->width;
+    quad->scr_height = scr->height;
+    quad->tint[0] = (unsigned int)lroundf(sprite_group->multiply_color.r * opacity * 255);
+    quad->tint[1] = (unsigned int)lroundf(sprite_group->multiply_color.g * opacity * 255);
+    quad->tint[2] = (unsigned int)lroundf(sprite_group->multiply_color.b * opacity * 255);
+    quad->tint[3] = (unsigned int)lroundf(opacity * 255);
+    quad->blend_mode = layer->blend_mode;
+    return 1;
+}
+
+/// Prepare the quads of every visible layer of the given timeline's composition at the given frame.
+/// @param timeline The timeline of the composition to prepare the quads of.
+/// @param frame The frame number within the composition's timeline to prepare the quads at.
+/// @param binding The binding of the given timeline's composition.
+/// @param textures The textures of the render, to mark the textures of the quads as used within.
+/// @param num_quads The number of quads that were prepared.
+/// @returns All the prepared quads, ordered back to front.
+/// Allocated.
+struct aet_render_quad_t *aet_render_quads_prepare(const struct aet_timeline_t *timeline,
+                                                   float frame,
+                                                   const struct aet_binding_t *binding,
+                                                   struct aet_render_textures_t *textures,
+                                                   unsigned int *num_quads)
+{
+    const struct aet_composition_t *composition = timeline->composition;
+    assert(binding->composition == composition);
+
+    // evaluate the frame
+    struct aet_state_t state;
+    aet_state_create(timeline, &state);
+    aet_state_evaluate(&state, frame);
+
+    struct aet_render_quad_t *quads = allocator_malloc(state.num_layer_states * sizeof(struct aet_render_quad_t));
+    unsigned int quad_index = 0;
+    for (int i = 0; i < state.num_layer_states; i++)
+        if (aet_render_quad_prepare(composition,
+                                    &state.layer_states[i],
+                                    binding,
+                                    textures,
+                                    composition->width,
+                                    composition->height,
+                                    &quads[quad_index]))
+            quad_index++;
+
+    aet_state_destroy(&state);
+
+    *num_quads = quad_index;
+    return quads;
+}
+
+/// Set the texels of each of the given quads, from the given acquired textures of their render.
+/// @param quads The quads to set the texels of.
+/// @param num_quads The total number of quads within the given array.
+/// @param textures The textures of the render, with every used texture acquired.
+void aet_render_quads_resolve(struct aet_render_quad_t *quads,
+                              unsigned int num_quads,
+                              const struct aet_render_textures_t *textures)
+{
+    for (unsigned int i = 0; i < num_quads; i++)
+        quads[i].texels = textures->entries[quads[i].texture_index]->data;
+}
+
+/// Pop the next tile to render from the given worker's own queue, or steal one from another worker.
+///
+/// Workers take from the front of their own queue and steal from the back of others,
+/// so that the tiles each worker is left with stay contiguous.
+/// @param workers All the workers of the render.
+/// @param num_workers The total number of workers within the given array.
+/// @param worker_index The index of the worker taking a tile, within the given array.
+/// @param tile_index The index of the tile that was taken.
+/// @returns Whether or not a tile was taken, `0` once every queue is empty.
+int aet_render_worker_take(struct aet_render_worker_t *workers,
+                           unsigned int num_workers,
+                           unsigned int worker_index,
+                           unsigned int *tile_index)
+{
+    struct aet_render_worker_t *worker = &workers[worker_index];
+    pthread_mutex_lock(&worker->mutex);
+    int taken = (worker->first_tile < worker->end_tile);
+    if (taken)
+        *tile_index = worker->first_tile++;
+    pthread_mutex_unlock(&worker->mutex);
+    if (taken)
+        return 1;
+
+    for (unsigned int offset = 1; offset < num_workers; offset++)
+    {
+        struct aet_render_worker_t *victim = &workers[(worker_index + offset) % num_workers];
+        pthread_mutex_lock(&victim->mutex);
+        taken = (victim->first_tile < victim->end_tile);
+        if (taken)
+            *tile_index = --victim->end_tile;
+        pthread_mutex_unlock(&victim->mutex);
+        if (taken)
+            return 1;
+    }
+
+    return 0;
+}
+
+/// Render tiles until there are none left within any worker's queue.
+/// @param argument The worker rendering, as a `struct aet_render_worker_t *`.
+/// @returns `NULL`, for use with `pthread_create`.
+void *aet_render_worker_run(void *argument)
+{
+    struct aet_render_worker_t *worker = argument;
+    const struct aet_render_bins_t *bins = worker->bins;
+    int tile_size = aet_render_tile_size;
+    uint8_t span[tile_size * 4];
+
+    unsigned int tile_index;
+    while (aet_render_worker_take(worker - worker->index, worker->num_workers, worker->index, &tile_index))
+    {
+        int min_x = (tile_index % bins->num_columns) * tile_size;
+        int min_y = (tile_index / bins->num_columns) * tile_size;
+        int max_x = (min_x + tile_size < bins->width) ? min_x + tile_size : bins->width;
+        int max_y = (min_y + tile_size < bins->height) ? min_y + tile_size : bins->height;
+
+        // the bins keep their quads back to front, so the layer order is kept within every tile
+        for (uint32_t i = bins->offsets[tile_index]; i < bins->offsets[tile_index + 1]; i++)
+            aet_render_quad_draw(&bins->quads[bins->quad_indices[i]],
+                                 bins->target,
+                                 bins->stride,
+                                 min_x,
+                                 min_y,
+                                 max_x,
+                                 max_y,
+                                 span);
+    }
+
+    return NULL;
+}
+
+void aet_composition_render(const struct aet_timeline_t *timeline,
+                            float frame,
+                            const struct aet_binding_t *binding,
+                            struct texture_cache_t *cache,
+                            uint8_t *out_rgba,
+                            size_t stride)
+{
+    const struct aet_composition_t *composition = timeline->composition;
+    struct aet_render_textures_t textures;
+    aet_render_textures_create(binding, cache, &textures);
+
+    unsigned int num_quads;
+    struct aet_render_quad_t *quads = aet_render_quads_prepare(timeline, frame, binding, &textures, &num_quads);
+    aet_render_textures_acquire(&textures);
+    aet_render_quads_resolve(quads, num_quads, &textures);
+
+    // draw every quad, back to front
+    uint8_t *span = allocator_malloc(composition->width * 4);
+    for (unsigned int i = 0; i < num_quads; i++)
+        aet_render_quad_draw(&quads[i], out_rgba, stride, 0, 0, composition->width, composition->height, span);
+
+    allocator_free(span);
+    allocator_free(quads);
+    aet_render_textures_destroy(&textures);
+}
+
+void aet_composition_render_binned(const struct aet_timeline_t *timeline,
+                                   float frame,
+                                   const struct aet_binding_t *binding,
+                                   struct texture_cache_t *cache,
+                                   uint8_t *out_rgba,
+                                   size_t stride,
+                                   unsigned int num_threads)
+{
+    const struct aet_composition_t *composition = timeline->composition;
+    struct aet_render_textures_t textures;
+    aet_render_textures_create(binding, cache, &textures);
+
+    unsigned int num_quads;
+    struct aet_render_quad_t *quads = aet_render_quads_prepare(timeline, frame, binding, &textures, &num_quads);
+
+    // bin the quads into every tile that their bounds overlap
+    // this is done in two passes, counting and then filling, so that each bin is contiguous
+    struct aet_render_bins_t bins;
+    int tile_size = aet_render_tile_size;
+    bins.width = composition->width;
+    bins.height = composition->height;
+    bins.num_columns = (bins.width + tile_size - 1) / tile_size;
+    bins.num_rows = (bins.height + tile_size - 1) / tile_size;
+    bins.target = out_rgba;
+    bins.stride = stride;
+    bins.quads = quads;
+
+    unsigned int num_tiles = bins.num_columns * bins.num_rows;
+    bins.offsets = allocator_calloc(num_tiles + 1, sizeof(uint32_t));
+    for (unsigned int i = 0; i < num_quads; i++)
+        for (int row = quads[i].min_y / tile_size; row <= (quads[i].max_y - 1) / tile_size; row++)
+            for (int column = quads[i].min_x / tile_size; column <= (quads[i].max_x - 1) / tile_size; column++)
+                bins.offsets[(row * bins.num_columns) + column + 1]++;
+
+    for (unsigned int t = 0; t < num_tiles; t++)
+        bins.offsets[t + 1] += bins.offsets[t];
+
+    uint32_t *positions = allocator_malloc((num_tiles + 1) * sizeof(uint32_t));
+    memcpy(positions, bins.offsets, (num_tiles + 1) * sizeof(uint32_t));
+    bins.quad_indices = allocator_malloc(bins.offsets[num_tiles] * sizeof(uint32_t));
+    for (unsigned int i = 0; i < num_quads; i++)
+        for (int row = quads[i].min_y / tile_size; row <= (quads[i].max_y - 1) / tile_size; row++)
+            for (int column = quads[i].min_x / tile_size; column <= (quads[i].max_x - 1) / tile_size; column++)
+                bins.quad_indices[positions[(row * bins.num_columns) + column]++] = i;
+
+    allocator_free(positions);
+
+    // split the tiles evenly over the workers, who then steal from each other as they run out
+    if (num_threads < 1)
+        num_threads = 1;
+    if (num_threads > num_tiles)
+        num_threads = (num_tiles > 0) ? num_tiles : 1;
+
+    struct aet_render_worker_t *workers = allocator_malloc(num_threads * sizeof(struct aet_render_worker_t));
+    void **arguments = allocator_malloc(num_threads * sizeof(void *));
+    for (unsigned int t = 0; t < num_threads; t++)
+    {
+        workers[t].bins = &bins;
+        workers[t].index = t;
+        workers[t].num_workers = num_threads;
+        workers[t].first_tile = (unsigned int)(((uint64_t)num_tiles * t) / num_threads);
+        workers[t].end_tile = (unsigned int)(((uint64_t)num_tiles * (t + 1)) / num_threads);
+        pthread_mutex_init(&workers[t].mutex, NULL);
+    }
+
+    // acquire the textures in parallel first, as decoding any that are not already cached dominates the render
+    // the threads acquiring textures share the render's textures, so each is given the same argument
+    for (unsigned int t = 0; t < num_threads; t++)
+        arguments[t] = &textures;
+
+    aet_render_parallel(aet_render_textures_acquire, arguments, num_threads);
+    aet_render_quads_resolve(quads, num_quads, &textures);
+
+    // then render the tiles, with the calling thread as the first worker
+    for (unsigned int t = 0; t < num_threads; t++)
+        arguments[t] = &workers[t];
+
+    aet_render_parallel(aet_render_worker_run, arguments, num_threads);
+
+    for (unsigned int t = 0; t < num_threads; t++)
+        pthread_mutex_destroy(&workers[t].mutex);
+
+    allocator_free(arguments);
+    allocator_free(workers);
+    allocator_free(bins.quad_indices);
+    allocator_free(bins.offsets);
+    allocator_free(quads);
+    aet_render_textures_destroy(&textures);
+}
@@ -0,0 +1,433 @@
+//
+//  aet_residency.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "aet_residency.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+
+#include "allocator.h"
+#include "ctr_texture.h"
+
+// MARK: - Data Structures
+
+/// The data structure for a texture becoming needed or no longer needed at a given frame.
+struct aet_residency_event_t
+{
+    /// The frame number at which this event occurs.
+    float frame;
+
+    /// `1` if the texture becomes needed, or `-1` if it is no longer needed.
+    int delta;
+
+    /// The index of the texture within all the textures of all the SPRs.
+    unsigned int texture_id;
+};
+
+// MARK: - Functions
+
+/// Compare the two given residency events by their frame, for use with `qsort`.
+/// @param a The first event to compare.
+/// @param b The second event to compare.
+/// @returns The order of the first event relative to the second.
+int aet_residency_event_compare(const void *a, const void *b)
+{
+    const struct aet_residency_event_t *event_a = a;
+    const struct aet_residency_event_t *event_b = b;
+    return (event_a->frame > event_b->frame) - (event_a->frame < event_b->frame);
+}
+
+/// Map the given range of a layer's own timeline onto the composition's timeline,
+/// clipped to the range throughout which the layer is active.
+/// @param timeline The timeline containing the layer.
+/// @param layer_index The index of the layer, within the composition's layers array.
+/// @param local_start The frame number within the layer's timeline at which the range begins, inclusive.
+/// @param local_end The frame number within the layer's timeline at which the range ends, exclusive.
+/// @param start The frame number within the composition's timeline at which the mapped range begins.
+/// @param end The frame number within the composition's timeline at which the mapped range ends.
+/// @returns Whether or not the mapped range contains any frames.
+int aet_residency_range_map(const struct aet_timeline_t *timeline,
+                            unsigned int layer_index,
+                            float local_start,
+                            float local_end,
+                            float *start,
+                            float *end)
+{
+    float frame_scale = timeline->frame_scales[layer_index];
+    float frame_offset = timeline->frame_offsets[layer_index];
+    float mapped_start = timeline->start_frames[layer_index];
+    float mapped_end = timeline->end_frames[layer_index];
+
+    // a frozen layer stays on the same local frame throughout
+    if (frame_scale == 0)
+    {
+        if (frame_offset < local_start || frame_offset >= local_end)
+            return 0;
+    }
+    else
+    {
+        float first = (local_start - frame_offset) / frame_scale;
+        float last = (local_end - frame_offset) / frame_scale;
+        if (frame_scale < 0)
+        {
+            float swap = first;
+            first = last;
+            last = swap;
+        }
+
+        mapped_start = fmaxf(mapped_start, first);
+        mapped_end = fminf(mapped_end, last);
+    }
+
+    *start = mapped_start;
+    *end = mapped_end;
+    return mapped_start < mapped_end;
+}
+
+void aet_residency_plan_create(const struct aet_timeline_t *timeline,
+                               const struct aet_binding_t *binding,
+                               struct aet_residency_plan_t *plan)
+{
+    const struct aet_composition_t *composition = timeline->composition;
+
+    // give every texture of every spr a single index
+    unsigned int texture_offsets[binding->num_sprs];
+    unsigned int num_texture_ids = 0;
+    for (int s = 0; s < binding->num_sprs; s++)
+    {
+        texture_offsets[s] = num_texture_ids;
+        num_texture_ids += binding->sprs[s].num_textures;
+    }
+
+    // create an event pair for the range of each sprite of each layer
+    unsigned int max_events = 0;
+    for (int i = 0; i < composition->num_layers; i++)
+        if (composition->layers[i].type == AET_LAYER_TYPE_SOURCE_SPRITE_GROUP)
+            max_events += composition->layers[i].sprite_group->num_sprites * 2;
+
+    struct aet_residency_event_t *events = allocator_malloc(max_events * sizeof(struct aet_residency_event_t));
+    unsigned int num_events = 0;
+    for (int i = 0; i < composition->num_layers; i++)
+    {
+        const struct aet_layer_t *layer = &composition->layers[i];
+        if (layer->type != AET_LAYER_TYPE_SOURCE_SPRITE_GROUP)
+            continue;
+
+        // flipbooks display one sprite per frame, holding the first and last sprites outside of the flipbook
+        unsigned int num_sprites = layer->sprite_group->num_sprites;
+        for (int s = 0; s < num_sprites; s++)
+        {
+            const struct aet_scr_binding_t *scr_binding = aet_binding_sprite(binding, &layer->sprite_group->sprites[s]);
+            if (scr_binding->scr == NULL)
+                continue;
+
+            float local_start = (s == 0) ? -INFINITY : s;
+            float local_end = (s == num_sprites - 1) ? INFINITY : s + 1;
+            float start, end;
+            if (!aet_residency_range_map(timeline, i, local_start, local_end, &start, &end))
+                continue;
+
+            unsigned int texture_id = texture_offsets[scr_binding->spr_index] + scr_binding->texture_index;
+            events[num_events++] = (struct aet_residency_event_t){ start, 1, texture_id };
+            events[num_events++] = (struct aet_residency_event_t){ end, -1, texture_id };
+        }
+    }
+
+    qsort(events, num_events, sizeof(struct aet_residency_event_t), aet_residency_event_compare);
+
+    // sweep the events, creating a segment between each distinct frame
+    // the counts are kept per texture, as multiple layers can need the same texture
+    unsigned int *counts = allocator_calloc(num_texture_ids, sizeof(unsigned int));
+    unsigned int max_segments = num_events;
+    plan->segments = allocator_malloc(max_segments * sizeof(struct aet_residency_segment_t));
+    plan->num_segments = 0;
+    plan->textures = NULL;
+    plan->num_textures = 0;
+
+    unsigned int max_textures = 0;
+    for (unsigned int e = 0; e < num_events;)
+    {
+        float frame = events[e].frame;
+        for (; e < num_events && events[e].frame == frame; e++)
+            counts[events[e].texture_id] += events[e].delta;
+
+        if (e == num_events)
+            break;
+
+        // gather the textures needed until the next event
+        unsigned int first_texture = plan->num_textures;
+        for (unsigned int s = 0; s < binding->num_sprs; s++)
+        {
+            for (unsigned int t = 0; t < binding->sprs[s].num_textures; t++)
+            {
+                if (counts[texture_offsets[s] + t] == 0)
+                    continue;
+
+                if (plan->num_textures == max_textures)
+                {
+                    max_textures = (max_textures > 0) ? max_textures * 2 : 64;
+                    plan->textures = allocator_realloc(plan->textures, max_textures * sizeof(struct aet_texture_ref_t));
+                }
+
+                plan->textures[plan->num_textures++] = (struct aet_texture_ref_t){ s, t };
+            }
+        }
+
+        // extend the previous segment instead if it needs the same textures
+        unsigned int num_textures = plan->num_textures - first_texture;
+        if (plan->num_segments > 0)
+        {
+            struct aet_residency_segment_t *previous = &plan->segments[plan->num_segments - 1];
+            if (previous->num_textures == num_textures &&
+                memcmp(&plan->textures[previous->first_texture],
+                       &plan->textures[first_texture],
+                       num_textures * sizeof(struct aet_texture_ref_t)) == 0)
+            {
+                previous->end_frame = events[e].frame;
+                plan->num_textures = first_texture;
+                continue;
+            }
+        }
+
+        struct aet_residency_segment_t *segment = &plan->segments[plan->num_segments++];
+        segment->start_frame = frame;
+        segment->end_frame = events[e].frame;
+        segment->first_texture = first_texture;
+        segment->num_textures = num_textures;
+    }
+
+    allocator_free(counts);
+    allocator_free(events);
+}
+
+void aet_residency_plan_destroy(struct aet_residency_plan_t *plan)
+{
+    allocator_free(plan->textures);
+    allocator_free(plan->segments);
+}
+
+const struct aet_residency_segment_t *aet_residency_plan_lookup(const struct aet_residency_plan_t *plan, float frame)
+{
+    // find the first segment ending after the frame
+    unsigned int low = 0;
+    unsigned int high = plan->num_segments;
+    while (low < high)
+    {
+        unsigned int middle = low + (high - low) / 2;
+        if (plan->segments[middle].end_frame <= frame)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if (low == plan->num_segments || plan->segments[low].start_frame > frame)
+        return NULL;
+
+    return &plan->segments[low];
+}
+
+/// Call the given function with the index within the given prefetcher's `textures`
+/// of every texture needed within the lookahead window of the given prefetcher's current frame.
+///
+/// Textures are visited in the order they are first needed, and may be visited more than once.
+/// The calling thread must hold the given prefetcher's mutex.
+/// @param prefetcher The prefetcher to visit the needed textures of.
+/// @param visit The function to call with each texture index, which returns whether or not to keep visiting.
+/// @param context The context to pass to the given function.
+void aet_prefetcher_window_visit(const struct aet_prefetcher_t *prefetcher,
+                                 int (*visit)(const struct aet_prefetcher_t *, unsigned int, void *),
+                                 void *context)
+{
+    const struct aet_residency_plan_t *plan = prefetcher->plan;
+    float window_start = prefetcher->frame;
+    float window_end = prefetcher->frame + prefetcher->lookahead;
+
+    // find the first segment ending after the window starts
+    unsigned int low = 0;
+    unsigned int high = plan->num_segments;
+    while (low < high)
+    {
+        unsigned int middle = low + (high - low) / 2;
+        if (plan->segments[middle].end_frame <= window_start)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    for (unsigned int s = low; s < plan->num_segments && plan->segments[s].start_frame <= window_end; s++)
+    {
+        const struct aet_residency_segment_t *segment = &plan->segments[s];
+        for (unsigned int t = 0; t < segment->num_textures; t++)
+        {
+            const struct aet_texture_ref_t *ref = &plan->textures[segment->first_texture + t];
+            if (!visit(prefetcher, prefetcher->texture_offsets[ref->spr_index] + ref->texture_index, context))
+                return;
+        }
+    }
+}
+
+/// Mark the given texture of the given prefetcher as wanted, for use with `aet_prefetcher_window_visit`.
+/// @param prefetcher The prefetcher containing the texture.
+/// @param texture_id The index of the texture within the given prefetcher's `textures`.
+/// @param context Unused.
+/// @returns `1`, to visit every texture.
+int aet_prefetcher_want(const struct aet_prefetcher_t *prefetcher, unsigned int texture_id, void *context)
+{
+    (void)context;
+    prefetcher->wanted[texture_id] = 1;
+    return 1;
+}
+
+/// Find the first needed texture of the given prefetcher which is not yet resident,
+/// for use with `aet_prefetcher_window_visit`.
+/// @param prefetcher The prefetcher containing the texture.
+/// @param texture_id The index of the texture within the given prefetcher's `textures`.
+/// @param context The `unsigned int` to write the index of the found texture to.
+/// @returns Whether or not to keep looking, `0` once a texture is found.
+int aet_prefetcher_find_missing(const struct aet_prefetcher_t *prefetcher, unsigned int texture_id, void *context)
+{
+    if (prefetcher->textures[texture_id] != NULL)
+        return 1;
+
+    *(unsigned int *)context = texture_id;
+    return 0;
+}
+
+/// Decode the textures needed by a prefetcher until it is destroyed.
+/// @param argument The prefetcher to decode the textures of, as a `struct aet_prefetcher_t *`.
+/// @returns `NULL`, for use with `pthread_create`.
+void *aet_prefetcher_run(void *argument)
+{
+    struct aet_prefetcher_t *prefetcher = argument;
+    const struct aet_binding_t *binding = prefetcher->binding;
+    allocator_set_thread(prefetcher->allocator);
+
+    pthread_mutex_lock(&prefetcher->mutex);
+    while (prefetcher->running)
+    {
+        unsigned int texture_id = UINT_MAX;
+        aet_prefetcher_window_visit(prefetcher, aet_prefetcher_find_missing, &texture_id);
+        if (texture_id == UINT_MAX)
+        {
+            pthread_cond_wait(&prefetcher->condition, &prefetcher->mutex);
+            continue;
+        }
+
+        // find the spr of the texture
+        unsigned int spr_index = 0;
+        while (spr_index + 1 < binding->num_sprs && prefetcher->texture_offsets[spr_index + 1] <= texture_id)
+            spr_index++;
+
+        const struct spr_t *spr = &binding->sprs[spr_index];
+        const struct ctr_texture_t *texture = &spr->textures[texture_id - prefetcher->texture_offsets[spr_index]];
+
+        // decode without holding the lock, so that playback is never blocked by decoding
+        // only the read holds the file's lock, and the texture is decoded from the heap rather than this thread's stack
+        pthread_mutex_unlock(&prefetcher->mutex);
+        uint8_t *encoded = allocator_malloc(texture->data_size);
+        flockfile(spr->file);
+        fseek(spr->file, texture->data_pointer, SEEK_SET);
+        fread(encoded, texture->data_size, 1, spr->file);
+        funlockfile(spr->file);
+
+        struct ctr_texture_unpack_options_t options = { CTR_TEXTURE_UNPACK_FORMAT_RGBA8888, CTR_TEXTURE_CHANNEL_ORDER_RGBA, 0, 0 };
+        uint8_t *unpacked = ctr_texture_decode_unpacked_encoded(texture, encoded, &options);
+        allocator_free(encoded);
+        pthread_mutex_lock(&prefetcher->mutex);
+
+        // the texture may no longer be needed if playback moved on while decoding
+        if (prefetcher->wanted[texture_id])
+            prefetcher->textures[texture_id] = unpacked;
+        else
+            allocator_free(unpacked);
+    }
+
+    pthread_mutex_unlock(&prefetcher->mutex);
+    return NULL;
+}
+
+void aet_prefetcher_create(const struct aet_residency_plan_t *plan,
+                           const struct aet_binding_t *binding,
+                           float lookahead,
+                           struct aet_prefetcher_t *prefetcher)
+{
+    prefetcher->plan = plan;
+    prefetcher->binding = binding;
+    prefetcher->lookahead = lookahead;
+    prefetcher->texture_offsets = allocator_malloc(binding->num_sprs * sizeof(unsigned int));
+    prefetcher->num_textures = 0;
+
+    for (int s = 0; s < binding->num_sprs; s++)
+    {
+        prefetcher->texture_offsets[s] = prefetcher->num_textures;
+        prefetcher->num_textures += binding->sprs[s].num_textures;
+    }
+
+    prefetcher->textures = allocator_calloc(prefetcher->num_textures, sizeof(uint8_t *));
+    prefetcher->wanted = allocator_calloc(prefetcher->num_textures, sizeof(uint8_t));
+    prefetcher->frame = (plan->num_segments > 0) ? plan->segments[0].start_frame : 0;
+    prefetcher->running = 1;
+    prefetcher->allocator = allocator_get_thread();
+    pthread_mutex_init(&prefetcher->mutex, NULL);
+    pthread_cond_init(&prefetcher->condition, NULL);
+    aet_prefetcher_window_visit(prefetcher, aet_prefetcher_want, NULL);
+
+    prefetcher->started = (pthread_create(&prefetcher->thread, NULL, aet_prefetcher_run, prefetcher) == 0);
+}
+
+void aet_prefetcher_destroy(struct aet_prefetcher_t *prefetcher)
+{
+    pthread_mutex_lock(&prefetcher->mutex);
+    prefetcher->running = 0;
+    pthread_cond_signal(&prefetcher->condition);
+    pthread_mutex_unlock(&prefetcher->mutex);
+    if (prefetcher->started)
+        pthread_join(prefetcher->thread, NULL);
+
+    for (int i = 0; i < prefetcher->num_textures; i++)
+        allocator_free(prefetcher->textures[i]);
+
+    pthread_cond_destroy(&prefetcher->condition);
+    pthread_mutex_destroy(&prefetcher->mutex);
+    allocator_free(prefetcher->wanted);
+    allocator_free(prefetcher->textures);
+    allocator_free(prefetcher->texture_offsets);
+}
+
+void aet_prefetcher_update(struct aet_prefetcher_t *prefetcher, float frame)
+{
+    pthread_mutex_lock(&prefetcher->mutex);
+    prefetcher->frame = frame;
+
+    // evict everything outside of the new window
+    memset(prefetcher->wanted, 0, prefetcher->num_textures);
+    aet_prefetcher_window_visit(prefetcher, aet_prefetcher_want, NULL);
+    for (unsigned int i = 0; i < prefetcher->num_textures; i++)
+    {
+        if (!prefetcher->wanted[i] && prefetcher->textures[i] != NULL)
+        {
+            allocator_free(prefetcher->textures[i]);
+            prefetcher->textures[i] = NULL;
+        }
+    }
+
+    pthread_cond_signal(&prefetcher->condition);
+    pthread_mutex_unlock(&prefetcher->mutex);
+}
+
+const uint8_t *aet_prefetcher_texture(struct aet_prefetcher_t *prefetcher,
+                                      unsigned int spr_index,
+                                      unsigned int texture_index)
+{
+    pthread_mutex_lock(&prefetcher->mutex);
+    const uint8_t *texture = prefetcher->textures[prefetcher->texture_offsets[spr_index] + texture_index];
+    pthread_mutex_unlock(&prefetcher->mutex);
+    return texture;
+}
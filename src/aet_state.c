@@ -0,0 +1,116 @@
+//
+//  aet_state.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "aet_state.h"
+
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+
+#include "allocator.h"
+
+// MARK: - Functions
+
+void aet_state_create(const struct aet_timeline_t *timeline, struct aet_state_t *state)
+{
+    unsigned int num_layers = timeline->num_layers;
+    state->timeline = timeline;
+    state->frame = 0;
+    state->num_layer_states = 0;
+    state->layer_states = allocator_malloc(num_layers * sizeof(struct aet_layer_state_t));
+    state->active_layer_indices = allocator_malloc(num_layers * sizeof(unsigned int));
+    state->world_matrices = allocator_malloc(num_layers * sizeof(struct matrix2d_t));
+    state->opacities = allocator_malloc(num_layers * sizeof(float));
+}
+
+void aet_state_destroy(struct aet_state_t *state)
+{
+    allocator_free(state->opacities);
+    allocator_free(state->world_matrices);
+    allocator_free(state->active_layer_indices);
+    allocator_free(state->layer_states);
+}
+
+struct matrix2d_t aet_layer_matrix(const struct aet_layer_t *layer, float layer_frame)
+{
+    float anchor_point_x = aet_layer_keyframes_sample(&layer->anchor_point_x, layer_frame);
+    float anchor_point_y = aet_layer_keyframes_sample(&layer->anchor_point_y, layer_frame);
+    float position_x = aet_layer_keyframes_sample(&layer->position_x, layer_frame);
+    float position_y = aet_layer_keyframes_sample(&layer->position_y, layer_frame);
+    float rotation = aet_layer_keyframes_sample(&layer->rotation, layer_frame);
+    float scale_x = aet_layer_keyframes_sample(&layer->scale_x, layer_frame);
+    float scale_y = aet_layer_keyframes_sample(&layer->scale_y, layer_frame);
+
+    // pixel space is y down, so a positive angle rotates clockwise
+    float radians = rotation * (float)M_PI / 180;
+    float cosine = cosf(radians);
+    float sine = sinf(radians);
+
+    // position * rotation * scale * -anchor point, expanded
+    struct matrix2d_t matrix;
+    matrix.a = cosine * scale_x;
+    matrix.b = sine * scale_x;
+    matrix.c = -sine * scale_y;
+    matrix.d = cosine * scale_y;
+    matrix.tx = position_x - (matrix.a * anchor_point_x) - (matrix.c * anchor_point_y);
+    matrix.ty = position_y - (matrix.b * anchor_point_x) - (matrix.d * anchor_point_y);
+    return matrix;
+}
+
+void aet_state_evaluate(struct aet_state_t *state, float frame)
+{
+    const struct aet_timeline_t *timeline = state->timeline;
+    const struct aet_composition_t *composition = timeline->composition;
+
+    // active layers come in draw order, where parents are always before their children,
+    // so the world matrix and opacity of a parent is always known by the time it is needed
+    unsigned int num_active = aet_timeline_active(timeline, frame, state->active_layer_indices);
+    unsigned int num_layer_states = 0;
+    for (int i = 0; i < num_active; i++)
+    {
+        unsigned int layer_index = state->active_layer_indices[i];
+        const struct aet_layer_t *layer = &composition->layers[layer_index];
+        float layer_frame = (frame * timeline->frame_scales[layer_index]) + timeline->frame_offsets[layer_index];
+
+        struct matrix2d_t world_matrix = aet_layer_matrix(layer, layer_frame);
+        float opacity = aet_layer_keyframes_sample(&layer->opacity, layer_frame);
+
+        unsigned int parent_index = timeline->parent_indices[layer_index];
+        if (parent_index != UINT_MAX)
+        {
+            world_matrix = matrix2d_multiply(state->world_matrices[parent_index], world_matrix);
+            opacity *= state->opacities[parent_index];
+        }
+
+        state->world_matrices[layer_index] = world_matrix;
+        state->opacities[layer_index] = opacity;
+
+        // only sprite group layers with something to show are visible
+        if (layer->type != AET_LAYER_TYPE_SOURCE_SPRITE_GROUP)
+            continue;
+        if (opacity <= 0 || layer->sprite_group->num_sprites == 0)
+            continue;
+
+        // sprite groups with multiple sprites are played as a flipbook, one sprite per frame
+        // hold the first and last sprites outside of the flipbook
+        unsigned int sprite_index = 0;
+        if (layer_frame > 0)
+            sprite_index = (unsigned int)floorf(layer_frame);
+        if (sprite_index >= layer->sprite_group->num_sprites)
+            sprite_index = layer->sprite_group->num_sprites - 1;
+
+        struct aet_layer_state_t *layer_state = &state->layer_states[num_layer_states++];
+        layer_state->layer_index = layer_index;
+        layer_state->sprite_index = sprite_index;
+        layer_state->opacity = opacity;
+        layer_state->world_matrix = world_matrix;
+    }
+
+    state->frame = frame;
+    state->num_layer_states = num_layer_states;
+}
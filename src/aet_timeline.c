@@ -0,0 +1,418 @@
+//
+//  aet_timeline.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "aet_timeline.h"
+
+#include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include <assert.h>
+
+#include "allocator.h"
+
+// MARK: - Data Structures
+
+/// The data structure for sorting layer indices by a frame number.
+struct aet_timeline_sort_item_t
+{
+    /// The frame number to sort by.
+    float frame;
+
+    /// The index of the layer that this item represents.
+    unsigned int layer_index;
+};
+
+/// The data structure for a node being visited within a timeline's max end frame tree.
+struct aet_timeline_tree_node_t
+{
+    /// The index of this node within the tree.
+    unsigned int index;
+
+    /// The index of the first leaf beneath this node.
+    unsigned int first_leaf;
+
+    /// The total number of leaves beneath this node.
+    unsigned int num_leaves;
+};
+
+// MARK: - Functions
+
+/// Compare the two given timeline sort items, for use with `qsort`.
+///
+/// Items of equal frames are ordered by their layer index so that the order is always stable.
+/// @param a The first item to compare.
+/// @param b The second item to compare.
+/// @returns The order of the first item relative to the second.
+int aet_timeline_sort_item_compare(const void *a, const void *b)
+{
+    const struct aet_timeline_sort_item_t *item_a = a;
+    const struct aet_timeline_sort_item_t *item_b = b;
+    if (item_a->frame < item_b->frame)
+        return -1;
+    if (item_a->frame > item_b->frame)
+        return 1;
+    if (item_a->layer_index < item_b->layer_index)
+        return -1;
+    if (item_a->layer_index > item_b->layer_index)
+        return 1;
+    return 0;
+}
+
+/// Compare the two given unsigned integers, for use with `qsort`.
+/// @param a The first unsigned integer to compare.
+/// @param b The second unsigned integer to compare.
+/// @returns The order of the first unsigned integer relative to the second.
+int aet_timeline_unsigned_compare(const void *a, const void *b)
+{
+    unsigned int value_a = *(const unsigned int *)a;
+    unsigned int value_b = *(const unsigned int *)b;
+    return (value_a > value_b) - (value_a < value_b);
+}
+
+/// Resolve the timeline mapping, active interval, and draw order of the given layer and all of it's children.
+/// @param timeline The timeline to write the resolved properties to.
+/// @param layer_index The index of the layer to resolve.
+/// @param parent_index The index of the parent of the layer to resolve, or `UINT_MAX` if it has no parent.
+/// @param draw_rank The next unused draw rank, modified to increment past each layer that is resolved.
+void aet_timeline_layer_resolve(struct aet_timeline_t *timeline,
+                                unsigned int layer_index,
+                                unsigned int parent_index,
+                                unsigned int *draw_rank)
+{
+    const struct aet_composition_t *composition = timeline->composition;
+    const struct aet_layer_t *layer = &composition->layers[layer_index];
+
+    // get the mapping from the composition's timeline to the parent's timeline
+    // and the frames within the composition's timeline that the parent is active for
+    // layers without a parent are relative to the composition itself, so use an identity mapping
+    float parent_frame_scale = 1, parent_frame_offset = 0;
+    float parent_start_frame = -INFINITY, parent_end_frame = INFINITY;
+    if (parent_index != UINT_MAX)
+    {
+        parent_frame_scale = timeline->frame_scales[parent_index];
+        parent_frame_offset = timeline->frame_offsets[parent_index];
+        parent_start_frame = timeline->start_frames[parent_index];
+        parent_end_frame = timeline->end_frames[parent_index];
+    }
+
+    // map the start and end frames back to the composition's timeline,
+    // and clamp them to when the parent is active
+    float start_frame, end_frame;
+    if (parent_frame_scale > 0)
+    {
+        start_frame = (layer->timeline_start_frame - parent_frame_offset) / parent_frame_scale;
+        end_frame = (layer->timeline_end_frame - parent_frame_offset) / parent_frame_scale;
+    }
+    else if (parent_frame_scale < 0)
+    {
+        // the parent plays backwards, so this layer is met end first
+        start_frame = (layer->timeline_end_frame - parent_frame_offset) / parent_frame_scale;
+        end_frame = (layer->timeline_start_frame - parent_frame_offset) / parent_frame_scale;
+    }
+    else
+    {
+        // the parent's timeline is frozen at a single frame,
+        // so this layer is either active whenever the parent is or never
+        start_frame = parent_start_frame;
+        end_frame = parent_end_frame;
+        if (parent_frame_offset < layer->timeline_start_frame || parent_frame_offset >= layer->timeline_end_frame)
+            end_frame = start_frame;
+    }
+
+    if (start_frame < parent_start_frame)
+        start_frame = parent_start_frame;
+    if (end_frame > parent_end_frame)
+        end_frame = parent_end_frame;
+
+    // empty intervals are kept as is, as they are never active either way
+    timeline->parent_indices[layer_index] = parent_index;
+    timeline->start_frames[layer_index] = start_frame;
+    timeline->end_frames[layer_index] = end_frame;
+
+    // chain this layer's own timeline onto the parent's mapping
+    timeline->frame_scales[layer_index] = parent_frame_scale * layer->timeline_speed;
+    timeline->frame_offsets[layer_index] = aet_layer_frame(layer, parent_frame_offset);
+
+    // the first layer in a list is the top-most, so children are drawn in reverse
+    timeline->draw_ranks[layer_index] = *draw_rank;
+    timeline->draw_order[*draw_rank] = layer_index;
+    (*draw_rank)++;
+
+    for (int c = layer->num_children - 1; c >= 0; c--)
+    {
+        unsigned int child_index = (unsigned int)(layer->children[c] - composition->layers);
+        aet_timeline_layer_resolve(timeline, child_index, layer_index, draw_rank);
+    }
+}
+
+void aet_timeline_create(const struct aet_composition_t *composition, struct aet_timeline_t *timeline)
+{
+    unsigned int num_layers = composition->num_layers;
+    timeline->composition = composition;
+    timeline->num_layers = num_layers;
+    timeline->parent_indices = allocator_malloc(num_layers * sizeof(unsigned int));
+    timeline->start_frames = allocator_malloc(num_layers * sizeof(float));
+    timeline->end_frames = allocator_malloc(num_layers * sizeof(float));
+    timeline->frame_scales = allocator_malloc(num_layers * sizeof(float));
+    timeline->frame_offsets = allocator_malloc(num_layers * sizeof(float));
+    timeline->draw_ranks = allocator_malloc(num_layers * sizeof(unsigned int));
+    timeline->draw_order = allocator_malloc(num_layers * sizeof(unsigned int));
+    timeline->start_order = allocator_malloc(num_layers * sizeof(unsigned int));
+    timeline->end_order = allocator_malloc(num_layers * sizeof(unsigned int));
+
+    // find the root layers
+    // these are all the layers which are not a child of any other layer
+    int *is_child = allocator_calloc(num_layers, sizeof(int));
+    for (int i = 0; i < num_layers; i++)
+    {
+        const struct aet_layer_t *layer = &composition->layers[i];
+        for (int c = 0; c < layer->num_children; c++)
+            is_child[layer->children[c] - composition->layers] = 1;
+    }
+
+    // resolve every layer through its root
+    // roots are in the same top to bottom order as children, so walk them in reverse
+    unsigned int draw_rank = 0;
+    for (int i = num_layers - 1; i >= 0; i--)
+        if (!is_child[i])
+            aet_timeline_layer_resolve(timeline, i, UINT_MAX, &draw_rank);
+
+    allocator_free(is_child);
+    assert(draw_rank == num_layers);
+
+    // sort the layers by their start and end frames
+    struct aet_timeline_sort_item_t *items = allocator_malloc(num_layers * sizeof(struct aet_timeline_sort_item_t));
+    for (int i = 0; i < num_layers; i++)
+    {
+        items[i].frame = timeline->start_frames[i];
+        items[i].layer_index = i;
+    }
+
+    qsort(items, num_layers, sizeof(struct aet_timeline_sort_item_t), aet_timeline_sort_item_compare);
+    for (int i = 0; i < num_layers; i++)
+        timeline->start_order[i] = items[i].layer_index;
+
+    for (int i = 0; i < num_layers; i++)
+    {
+        items[i].frame = timeline->end_frames[i];
+        items[i].layer_index = i;
+    }
+
+    qsort(items, num_layers, sizeof(struct aet_timeline_sort_item_t), aet_timeline_sort_item_compare);
+    for (int i = 0; i < num_layers; i++)
+        timeline->end_order[i] = items[i].layer_index;
+
+    allocator_free(items);
+
+    // build the max end frame tree over the start order
+    // leaves beyond the layer count end before any frame so they are always skipped
+    unsigned int num_tree_leaves = 1;
+    while (num_tree_leaves < num_layers)
+        num_tree_leaves *= 2;
+
+    timeline->num_tree_leaves = num_tree_leaves;
+    timeline->max_end_frames = allocator_malloc(2 * num_tree_leaves * sizeof(float));
+    for (int i = 0; i < num_tree_leaves; i++)
+    {
+        float end_frame = -INFINITY;
+        if (i < num_layers)
+            end_frame = timeline->end_frames[timeline->start_order[i]];
+
+        timeline->max_end_frames[num_tree_leaves + i] = end_frame;
+    }
+
+    for (int i = num_tree_leaves - 1; i > 0; i--)
+    {
+        float left = timeline->max_end_frames[i * 2];
+        float right = timeline->max_end_frames[i * 2 + 1];
+        timeline->max_end_frames[i] = (left > right) ? left : right;
+    }
+}
+
+void aet_timeline_destroy(struct aet_timeline_t *timeline)
+{
+    allocator_free(timeline->max_end_frames);
+    allocator_free(timeline->end_order);
+    allocator_free(timeline->start_order);
+    allocator_free(timeline->draw_order);
+    allocator_free(timeline->draw_ranks);
+    allocator_free(timeline->frame_offsets);
+    allocator_free(timeline->frame_scales);
+    allocator_free(timeline->end_frames);
+    allocator_free(timeline->start_frames);
+    allocator_free(timeline->parent_indices);
+}
+
+int aet_timeline_layer_active(const struct aet_timeline_t *timeline, unsigned int layer_index, float frame)
+{
+    return timeline->start_frames[layer_index] <= frame && frame < timeline->end_frames[layer_index];
+}
+
+/// Get the number of items within the given sorted order whose frame is at or before the given frame.
+/// @param order The layer indices to search, sorted by the given frames.
+/// @param frames The frame number of each layer.
+/// @param num_layers The total number of items within the given order.
+/// @param frame The frame number to search for.
+/// @returns The number of items within the given order whose frame is at or before the given frame.
+unsigned int aet_timeline_order_search(const unsigned int *order,
+                                       const float *frames,
+                                       unsigned int num_layers,
+                                       float frame)
+{
+    unsigned int low = 0;
+    unsigned int high = num_layers;
+    while (low < high)
+    {
+        unsigned int middle = low + (high - low) / 2;
+        if (frames[order[middle]] <= frame)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    return low;
+}
+
+unsigned int aet_timeline_active(const struct aet_timeline_t *timeline, float frame, unsigned int *layer_indices)
+{
+    // only layers that have started can be active
+    unsigned int num_started = aet_timeline_order_search(timeline->start_order,
+                                                         timeline->start_frames,
+                                                         timeline->num_layers,
+                                                         frame);
+
+    if (num_started == 0)
+        return 0;
+
+    // walk the tree over the started layers, skipping any subtree that has entirely ended
+    // the stack only ever holds one pending sibling per level of the tree, plus the current node
+    struct aet_timeline_tree_node_t stack[sizeof(unsigned int) * 8 + 1];
+    unsigned int stack_size = 0;
+    stack[stack_size++] = (struct aet_timeline_tree_node_t){ 1, 0, timeline->num_tree_leaves };
+
+    unsigned int num_active = 0;
+    while (stack_size > 0)
+    {
+        struct aet_timeline_tree_node_t node = stack[--stack_size];
+        if (node.first_leaf >= num_started || timeline->max_end_frames[node.index] <= frame)
+            continue;
+
+        if (node.num_leaves == 1)
+        {
+            // the start is known to be at or before the frame, and the end after it
+            // collect the draw rank rather than the index so the result can be sorted into draw order
+            unsigned int layer_index = timeline->start_order[node.first_leaf];
+            layer_indices[num_active++] = timeline->draw_ranks[layer_index];
+            continue;
+        }
+
+        // push the right child first so the left is visited first
+        unsigned int half = node.num_leaves / 2;
+        stack[stack_size++] = (struct aet_timeline_tree_node_t){ node.index * 2 + 1, node.first_leaf + half, half };
+        stack[stack_size++] = (struct aet_timeline_tree_node_t){ node.index * 2, node.first_leaf, half };
+    }
+
+    // the draw ranks were collected, so sort them and map them back to layers
+    qsort(layer_indices, num_active, sizeof(unsigned int), aet_timeline_unsigned_compare);
+    for (int i = 0; i < num_active; i++)
+        layer_indices[i] = timeline->draw_order[layer_indices[i]];
+
+    return num_active;
+}
+
+void aet_timeline_cursor_seek(const struct aet_timeline_t *timeline, float frame, struct aet_timeline_cursor_t *cursor)
+{
+    cursor->timeline = timeline;
+    cursor->frame = frame;
+    cursor->start_position = aet_timeline_order_search(timeline->start_order,
+                                                       timeline->start_frames,
+                                                       timeline->num_layers,
+                                                       frame);
+    cursor->end_position = aet_timeline_order_search(timeline->end_order,
+                                                     timeline->end_frames,
+                                                     timeline->num_layers,
+                                                     frame);
+}
+
+void aet_timeline_cursor_advance(struct aet_timeline_cursor_t *cursor,
+                                 float frame,
+                                 unsigned int *entered_layer_indices,
+                                 unsigned int *num_entered,
+                                 unsigned int *exited_layer_indices,
+                                 unsigned int *num_exited)
+{
+    const struct aet_timeline_t *timeline = cursor->timeline;
+    float previous_frame = cursor->frame;
+    unsigned int start_position = cursor->start_position;
+    unsigned int end_position = cursor->end_position;
+    *num_entered = 0;
+    *num_exited = 0;
+
+    if (frame >= previous_frame)
+    {
+        // layers starting since the previous frame have entered,
+        // unless they have also already ended
+        while (start_position < timeline->num_layers)
+        {
+            unsigned int layer_index = timeline->start_order[start_position];
+            if (timeline->start_frames[layer_index] > frame)
+                break;
+
+            if (timeline->end_frames[layer_index] > frame)
+                entered_layer_indices[(*num_entered)++] = layer_index;
+
+            start_position++;
+        }
+
+        // layers ending since the previous frame have exited,
+        // but only if they were active at the previous frame
+        while (end_position < timeline->num_layers)
+        {
+            unsigned int layer_index = timeline->end_order[end_position];
+            if (timeline->end_frames[layer_index] > frame)
+                break;
+
+            if (timeline->start_frames[layer_index] <= previous_frame)
+                exited_layer_indices[(*num_exited)++] = layer_index;
+
+            end_position++;
+        }
+    }
+    else
+    {
+        // the same as moving forwards but mirrored,
+        // un-starting a layer exits it and un-ending a layer enters it
+        while (start_position > 0)
+        {
+            unsigned int layer_index = timeline->start_order[start_position - 1];
+            if (timeline->start_frames[layer_index] <= frame)
+                break;
+
+            if (timeline->end_frames[layer_index] > previous_frame)
+                exited_layer_indices[(*num_exited)++] = layer_index;
+
+            start_position--;
+        }
+
+        while (end_position > 0)
+        {
+            unsigned int layer_index = timeline->end_order[end_position - 1];
+            if (timeline->end_frames[layer_index] <= frame)
+                break;
+
+            if (timeline->start_frames[layer_index] <= frame)
+                entered_layer_indices[(*num_entered)++] = layer_index;
+
+            end_position--;
+        }
+    }
+
+    cursor->frame = frame;
+    cursor->start_position = start_position;
+    cursor->end_position = end_position;
+}
@@ -0,0 +1,92 @@
+//
+//  allocator.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "allocator.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+// MARK: - Variables
+
+/// The allocator used by threads that have not set their own, or `NULL` for the standard library.
+const struct allocator_t *allocator_global = NULL;
+
+/// The allocator used by the current thread, or `NULL` for the global allocator.
+_Thread_local const struct allocator_t *allocator_thread = NULL;
+
+// MARK: - Functions
+
+/// Get the allocator that the calling thread should allocate with.
+/// @returns The allocator of the calling thread, or `NULL` for the standard library.
+const struct allocator_t *allocator_current(void)
+{
+    return allocator_thread != NULL ? allocator_thread : allocator_global;
+}
+
+void allocator_set_global(const struct allocator_t *allocator)
+{
+    allocator_global = allocator;
+}
+
+const struct allocator_t *allocator_set_thread(const struct allocator_t *allocator)
+{
+    const struct allocator_t *previous = allocator_thread;
+    allocator_thread = allocator;
+    return previous;
+}
+
+const struct allocator_t *allocator_get_thread(void)
+{
+    return allocator_thread;
+}
+
+void *allocator_malloc(size_t size)
+{
+    const struct allocator_t *allocator = allocator_current();
+    if (allocator == NULL)
+        return malloc(size);
+
+    return allocator->allocate(size, allocator->context);
+}
+
+void *allocator_calloc(size_t count, size_t size)
+{
+    const struct allocator_t *allocator = allocator_current();
+    if (allocator == NULL)
+        return calloc(count, size);
+
+    assert(size == 0 || count <= SIZE_MAX / size);
+    void *pointer = allocator->allocate(count * size, allocator->context);
+    if (pointer != NULL)
+        memset(pointer, 0, count * size);
+
+    return pointer;
+}
+
+void *allocator_realloc(void *pointer, size_t size)
+{
+    const struct allocator_t *allocator = allocator_current();
+    if (allocator == NULL)
+        return realloc(pointer, size);
+
+    return allocator->reallocate(pointer, size, allocator->context);
+}
+
+void allocator_free(void *pointer)
+{
+    if (pointer == NULL)
+        return;
+
+    const struct allocator_t *allocator = allocator_current();
+    if (allocator == NULL)
+        free(pointer);
+    else
+        allocator->release(pointer, allocator->context);
+}
@@ -9,88 +9,263 @@
 #include "ctpk.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <assert.h>
 
+#include "allocator.h"
+#include "utils.h"
+
+// MARK: - Constants
+
+/// The size of the header of each CTPK, in bytes.
+const size_t ctpk_header_size = 32;
+
+/// The size of each texture entry within a CTPK, in bytes.
+const size_t ctpk_entry_size = 36;
+
 // MARK: - Functions
 
+/// Read the CTPK header at the given offset of the given file handle.
+/// @param file The file handle to read the header from.
+/// @param pointer The offset of the CTPK within the file, in bytes.
+/// @param num_textures The texture count of the CTPK.
+/// @param data_base_pointer The offset of the CTPK's texture data, relative to the CTPK.
+/// @param hash_section_pointer The offset of the CTPK's name hash section, relative to the CTPK.
+void ctpk_header_read(FILE *file,
+                      long pointer,
+                      uint16_t *num_textures,
+                      uint32_t *data_base_pointer,
+                      uint32_t *hash_section_pointer)
+{
+    uint8_t header[ctpk_header_size];
+    utils_read_block(file, pointer, ctpk_header_size, header);
+
+    // signature
+    assert(memcmp(header, "CTPK", 4) == 0);
+
+    // values
+    //  - u16 version, unused
+    //  - u16 texture count
+    //  - u32 data base pointer
+    //  - u32 total texture data size, unused
+    //  - u32 hash section pointer
+    //  - u32 conversion info pointer, unused
+    //  - 8x byte padding
+    *num_textures = utils_load_u16(header + 6);
+    *data_base_pointer = utils_load_u32(header + 8);
+    *hash_section_pointer = utils_load_u32(header + 16);
+}
+
+/// Decode the given CTPK texture entry.
+/// @param entry The entry to decode, of `ctpk_entry_size` bytes.
+/// @param pointer The offset of the CTPK containing the entry within the file, in bytes.
+/// @param data_base_pointer The offset of the CTPK's texture data, relative to the CTPK.
+/// @param texture The CTR texture to decode the entry into.
+/// @returns The offset of the entry's texture name, relative to the CTPK.
+uint32_t ctpk_entry_decode(const uint8_t *entry, long pointer, uint32_t data_base_pointer, struct ctr_texture_t *texture)
+{
+    // file path pointer
+    uint32_t name_pointer = utils_load_u32(entry);
+
+    // data size and pointer
+    // note that the data pointer is relative to the data base pointer
+    uint32_t data_size = utils_load_u32(entry + 4);
+    uint32_t data_pointer = utils_load_u32(entry + 8);
+
+    // data format
+    enum ctr_texture_format_t data_format = utils_load_u32(entry + 12);
+
+    // size
+    uint16_t width = utils_load_u16(entry + 16);
+    uint16_t height = utils_load_u16(entry + 18);
+
+    // mipmap level count
+    uint8_t num_levels = entry[20];
+
+    // multiple unused values
+    //  - u8 type
+    //  - u16 cube map info
+    //  - u32 bitmap size array pointer
+    //  - u32 timestamp
+
+    // create the texture
+    ctr_texture_create(width,
+                       height,
+                       data_size,
+                       pointer + data_base_pointer + data_pointer,
+                       data_format,
+                       texture);
+
+    // only keep the levels whose data is within the texture's data
+    // a level count of zero is treated as a single level
+    unsigned int level_width = width, level_height = height;
+    size_t levels_size = ctr_texture_encoded_size(data_format, level_width, level_height);
+    texture->num_levels = 1;
+    while (texture->num_levels < num_levels)
+    {
+        level_width = level_width / 2 < 8 ? 8 : level_width / 2;
+        level_height = level_height / 2 < 8 ? 8 : level_height / 2;
+        levels_size += ctr_texture_encoded_size(data_format, level_width, level_height);
+        if (levels_size > data_size)
+            break;
+
+        texture->num_levels++;
+    }
+
+    return name_pointer;
+}
+
 void ctpk_open(FILE *file, struct ctpk_t *ctpk)
 {
     // read the pointer of this ctpk relative to the file
     // this is used to get the absolute position of texture data
     long pointer = ftell(file);
 
-    // read the signature
-    assert(fgetc(file) == 'C');
-    assert(fgetc(file) == 'T');
-    assert(fgetc(file) == 'P');
-    assert(fgetc(file) == 'K');
+    // read the header
+    uint16_t num_textures;
+    uint32_t data_base_pointer, hash_section_pointer;
+    ctpk_header_read(file, pointer, &num_textures, &data_base_pointer, &hash_section_pointer);
 
-    // u16 version, unused
-    fseek(file, 2, SEEK_CUR);
+    // read all the entries at once, directly after the header
+    uint8_t *entries = allocator_malloc(num_textures * ctpk_entry_size);
+    utils_read_block(file, pointer + ctpk_header_size, num_textures * ctpk_entry_size, entries);
 
-    // read the texture count and data base pointer
-    uint16_t num_textures;
-    fread(&num_textures, sizeof(num_textures), 1, file);
+    // decode the textures
+    ctpk->num_textures = num_textures;
+    ctpk->textures = allocator_malloc(num_textures * sizeof(struct ctr_texture_t));
+    for (int i = 0; i < num_textures; i++)
+        ctpk_entry_decode(entries + (i * ctpk_entry_size), pointer, data_base_pointer, &ctpk->textures[i]);
 
-    uint32_t data_base_pointer;
-    fread(&data_base_pointer, sizeof(data_base_pointer), 1, file);
+    allocator_free(entries);
+}
 
-    // multiple unused values
-    //  - u32 total texture data size
-    //  - u32 hash section pointer
-    //  - u32 conversion info pointer
-    //  - 8x byte padding
-    fseek(file, (3 * 4) + 8, SEEK_CUR);
+void ctpk_close(struct ctpk_t *ctpk)
+{
+    allocator_free(ctpk->textures);
+}
+
+/// Compare the two given CTPK name hashes by their hash, for use with `qsort`.
+/// @param a The first hash to compare.
+/// @param b The second hash to compare.
+/// @returns The order of the first hash relative to the second.
+int ctpk_hash_compare(const void *a, const void *b)
+{
+    const struct ctpk_hash_t *hash_a = a;
+    const struct ctpk_hash_t *hash_b = b;
+    if (hash_a->hash != hash_b->hash)
+        return (hash_a->hash > hash_b->hash) - (hash_a->hash < hash_b->hash);
+    return (hash_a->index > hash_b->index) - (hash_a->index < hash_b->index);
+}
+
+void ctpk_file_open(const char *path, struct ctpk_file_t *ctpk)
+{
+    // open the file
+    FILE *file = fopen(path, "rb");
+    assert(file != NULL);
+    ctpk->file = file;
+
+    // read the header
+    uint16_t num_textures;
+    uint32_t data_base_pointer, hash_section_pointer;
+    ctpk_header_read(file, 0, &num_textures, &data_base_pointer, &hash_section_pointer);
 
-    // read the textures
     ctpk->num_textures = num_textures;
-    ctpk->textures = malloc(num_textures * sizeof(struct ctr_texture_t));
+    ctpk->data_base_pointer = data_base_pointer;
+
+    // read the hash section
+    // each item is a u32 crc32 of the texture's name followed by the i32 index of the texture
+    ctpk->hashes = allocator_malloc(num_textures * sizeof(struct ctpk_hash_t));
+    uint8_t *hashes = allocator_malloc(num_textures * 8);
+    utils_read_block(file, hash_section_pointer, num_textures * 8, hashes);
     for (int i = 0; i < num_textures; i++)
     {
-        // array
-        // +32 for ctpk header size
-        fseek(file, pointer + 32 + (i * 36), SEEK_SET);
-
-        // u32 file path pointer, unused
-        fseek(file, 4, SEEK_CUR);
-
-        // read the data size and pointer
-        // note that the data pointer is relative to the data base pointer
-        uint32_t data_size, data_pointer;
-        fread(&data_size, sizeof(data_size), 1, file);
-        fread(&data_pointer, sizeof(data_pointer), 1, file);
-
-        // read the data format
-        enum ctr_texture_format_t data_format;
-        fread(&data_format, sizeof(data_format), 1, file);
-
-        // read the size
-        uint16_t width, height;
-        fread(&width, sizeof(width), 1, file);
-        fread(&height, sizeof(height), 1, file);
-
-        // multiple unused values
-        //  - u8 mip level
-        //  - u8 type
-        //  - u16 cube map info
-        //  - u32 bitmap size array pointer
-        //  - u32 timestamp
-        fseek(file, (1 * 2) + 2 + (2 * 4), SEEK_CUR);
-
-        // insert the texture
-        struct ctr_texture_t texture;
-        ctr_texture_create(width,
-                           height,
-                           data_size,
-                           pointer + data_base_pointer + data_pointer,
-                           data_format,
-                           &texture);
-
-        ctpk->textures[i] = texture;
+        uint32_t hash = utils_load_u32(hashes + (i * 8));
+        int32_t index = (int32_t)utils_load_u32(hashes + (i * 8) + 4);
+        assert(index >= 0 && index < num_textures);
+
+        ctpk->hashes[i].hash = hash;
+        ctpk->hashes[i].index = (unsigned int)index;
+    }
+
+    allocator_free(hashes);
+
+    // the section should already be sorted, but this is cheap and makes lookups safe regardless
+    qsort(ctpk->hashes, num_textures, sizeof(struct ctpk_hash_t), ctpk_hash_compare);
+
+    // the entries are read lazily as they are accessed
+    ctpk->entries = allocator_malloc(num_textures * sizeof(struct ctpk_file_entry_t));
+    for (int i = 0; i < num_textures; i++)
+    {
+        ctpk->entries[i].read = 0;
+        ctpk->entries[i].name = NULL;
     }
 }
 
-void ctpk_close(struct ctpk_t *ctpk)
+void ctpk_file_close(struct ctpk_file_t *ctpk)
+{
+    for (int i = 0; i < ctpk->num_textures; i++)
+        allocator_free(ctpk->entries[i].name);
+
+    allocator_free(ctpk->entries);
+    allocator_free(ctpk->hashes);
+    fclose(ctpk->file);
+}
+
+/// Get the given entry of the given CTPK file, reading it if it has not been read yet.
+/// @param ctpk The CTPK file to get the entry of.
+/// @param index The index of the entry to get.
+/// @returns The read entry.
+struct ctpk_file_entry_t *ctpk_file_entry(struct ctpk_file_t *ctpk, unsigned int index)
+{
+    assert(index < ctpk->num_textures);
+
+    struct ctpk_file_entry_t *entry = &ctpk->entries[index];
+    if (!entry->read)
+    {
+        uint8_t entry_data[ctpk_entry_size];
+        utils_read_block(ctpk->file, ctpk_header_size + (index * ctpk_entry_size), ctpk_entry_size, entry_data);
+        uint32_t name_pointer = ctpk_entry_decode(entry_data, 0, ctpk->data_base_pointer, &entry->texture);
+
+        fseek(ctpk->file, name_pointer, SEEK_SET);
+        entry->name = utils_read_string(ctpk->file);
+        entry->read = 1;
+    }
+
+    return entry;
+}
+
+const struct ctr_texture_t *ctpk_file_texture(struct ctpk_file_t *ctpk, unsigned int index)
+{
+    return &ctpk_file_entry(ctpk, index)->texture;
+}
+
+const char *ctpk_file_texture_name(struct ctpk_file_t *ctpk, unsigned int index)
 {
-    free(ctpk->textures);
+    return ctpk_file_entry(ctpk, index)->name;
+}
+
+int ctpk_file_find(struct ctpk_file_t *ctpk, const char *name)
+{
+    // find the first hash that is not less than the name's
+    uint32_t hash = utils_crc32(name, strlen(name));
+    unsigned int low = 0;
+    unsigned int high = ctpk->num_textures;
+    while (low < high)
+    {
+        unsigned int middle = low + (high - low) / 2;
+        if (ctpk->hashes[middle].hash < hash)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    // compare the names of every texture with the same hash, in case of collisions
+    for (unsigned int i = low; i < ctpk->num_textures && ctpk->hashes[i].hash == hash; i++)
+    {
+        unsigned int index = ctpk->hashes[i].index;
+        if (strcmp(ctpk_file_texture_name(ctpk, index), name) == 0)
+            return (int)index;
+    }
+
+    return -1;
 }
@@ -0,0 +1,142 @@
+//
+//  ctr_etc1.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "ctr_etc1.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "allocator.h"
+
+// MARK: - Constants
+
+/// The identifier at the beginning of every KTX file.
+const uint8_t ctr_etc1_ktx_identifier[12] =
+{
+    0xab, 'K', 'T', 'X', ' ', '1', '1', 0xbb, '\r', '\n', 0x1a, '\n'
+};
+
+/// The OpenGL internal format of ETC1 compressed textures, `GL_ETC1_RGB8_OES`.
+const uint32_t ctr_etc1_gl_internal_format = 0x8d64;
+
+/// The OpenGL base internal format of ETC1 compressed textures, `GL_RGB`.
+const uint32_t ctr_etc1_gl_base_internal_format = 0x1907;
+
+// MARK: - Functions
+
+/// Write the given value to the given file handle as a little endian u32.
+/// @param value The value to write.
+/// @param file The file handle to write the value to.
+void ctr_etc1_write_u32(uint32_t value, FILE *file)
+{
+    uint8_t bytes[4] = { value, value >> 8, value >> 16, value >> 24 };
+    fwrite(bytes, sizeof(bytes), 1, file);
+}
+
+uint8_t *ctr_etc1_read(const struct ctr_texture_t *texture,
+                       FILE *file,
+                       enum ctr_etc1_alpha_format_t alpha_format,
+                       uint8_t **alpha)
+{
+    assert(texture->data_format == CTR_TEXTURE_FORMAT_ETC1 || texture->data_format == CTR_TEXTURE_FORMAT_ETC1_A4);
+    assert(texture->width % 8 == 0 && texture->height % 8 == 0);
+
+    // read the data to reorder
+    uint8_t *raw_data = allocator_malloc(texture->data_size);
+    fseek(file, texture->data_pointer, SEEK_SET);
+    fread(raw_data, texture->data_size, 1, file);
+
+    // etc1_a4 blocks are each preceded by their 8 bytes of alpha
+    int has_alpha = texture->data_format == CTR_TEXTURE_FORMAT_ETC1_A4;
+    size_t block_stride = has_alpha ? 16 : 8;
+    size_t block_offset = has_alpha ? 8 : 0;
+
+    unsigned int w = texture->width;
+    unsigned int h = texture->height;
+    unsigned int blocks_width = w / 4;
+    uint8_t *blocks = allocator_malloc(w * h / 2);
+    uint8_t *alpha_plane = NULL;
+    if (has_alpha && alpha != NULL)
+        alpha_plane = allocator_malloc(alpha_format == CTR_ETC1_ALPHA_FORMAT_A8 ? w * h : w * h / 2);
+
+    // each 8x8 tile contains four blocks, ordered top left, top right, bottom left, then bottom right
+    const uint8_t *source = raw_data;
+    for (unsigned int tile_y = 0; tile_y < h / 8; tile_y++)
+    {
+        for (unsigned int tile_x = 0; tile_x < w / 8; tile_x++)
+        {
+            for (unsigned int b = 0; b < 4; b++, source += block_stride)
+            {
+                unsigned int block_x = tile_x * 2 + b % 2;
+                unsigned int block_y = tile_y * 2 + b / 2;
+
+                // reverse the bytes of the block into big endian
+                uint8_t *block = &blocks[(block_y * blocks_width + block_x) * 8];
+                for (unsigned int i = 0; i < 8; i++)
+                    block[i] = source[block_offset + 7 - i];
+
+                if (alpha_plane == NULL)
+                    continue;
+
+                // the alpha is column major, with two rows per byte and the upper row in the low bits
+                for (unsigned int x = 0; x < 4; x++)
+                {
+                    for (unsigned int y = 0; y < 4; y++)
+                    {
+                        uint8_t value = (source[x * 2 + y / 2] >> (y % 2 * 4)) & 0xf;
+                        unsigned int pixel_x = block_x * 4 + x;
+                        unsigned int pixel_y = block_y * 4 + y;
+                        if (alpha_format == CTR_ETC1_ALPHA_FORMAT_A8)
+                        {
+                            alpha_plane[pixel_y * w + pixel_x] = value * 0x11;
+                        }
+                        else
+                        {
+                            uint8_t *pair = &alpha_plane[(pixel_y * w + pixel_x) / 2];
+                            if (pixel_x % 2 == 0)
+                                *pair = value;
+                            else
+                                *pair |= value << 4;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    allocator_free(raw_data);
+    if (alpha != NULL)
+        *alpha = alpha_plane;
+
+    return blocks;
+}
+
+void ctr_etc1_write_ktx(const uint8_t *blocks, unsigned int width, unsigned int height, FILE *file)
+{
+    uint32_t image_size = width * height / 2;
+
+    fwrite(ctr_etc1_ktx_identifier, sizeof(ctr_etc1_ktx_identifier), 1, file);
+    ctr_etc1_write_u32(0x04030201, file); // endianness
+    ctr_etc1_write_u32(0, file); // gl type, compressed
+    ctr_etc1_write_u32(1, file); // gl type size
+    ctr_etc1_write_u32(0, file); // gl format, compressed
+    ctr_etc1_write_u32(ctr_etc1_gl_internal_format, file);
+    ctr_etc1_write_u32(ctr_etc1_gl_base_internal_format, file);
+    ctr_etc1_write_u32(width, file);
+    ctr_etc1_write_u32(height, file);
+    ctr_etc1_write_u32(0, file); // pixel depth
+    ctr_etc1_write_u32(0, file); // number of array elements
+    ctr_etc1_write_u32(1, file); // number of faces
+    ctr_etc1_write_u32(1, file); // number of mipmap levels
+    ctr_etc1_write_u32(0, file); // bytes of key value data
+
+    // etc1 images are always a multiple of 8 bytes, so no padding is needed
+    ctr_etc1_write_u32(image_size, file);
+    fwrite(blocks, image_size, 1, file);
+}
@@ -0,0 +1,148 @@
+//
+//  ctr_sampler.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "ctr_sampler.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+
+#include "allocator.h"
+
+// MARK: - Functions
+
+/// Get the given tile of the given sampler's texture, decoding it into the cache if it is not already cached.
+/// @param sampler The sampler to get the tile from.
+/// @param tile_x The X position of the tile, in tiles.
+/// @param tile_y The Y position of the tile, in tiles.
+/// @returns The unpacked texels of the tile, which are only valid until the sampler is next used.
+const uint8_t *ctr_sampler_tile(struct ctr_sampler_t *sampler, unsigned int tile_x, unsigned int tile_y)
+{
+    int tile_index = (int)(tile_y * (sampler->texture->width / 8) + tile_x);
+    struct ctr_sampler_tile_t *cached = &sampler->cached_tiles[tile_index % sampler->num_cached_tiles];
+    if (cached->tile_index != tile_index)
+    {
+        ctr_texture_decode_tile(sampler->texture, sampler->encoded, tile_x, tile_y, cached->texels);
+        cached->tile_index = tile_index;
+    }
+
+    return cached->texels;
+}
+
+void ctr_sampler_create(const struct ctr_texture_t *texture,
+                        FILE *file,
+                        unsigned int num_cached_tiles,
+                        struct ctr_sampler_t *sampler)
+{
+    assert(num_cached_tiles > 0);
+
+    sampler->texture = texture;
+    sampler->encoded = allocator_malloc(texture->data_size);
+    fseek(file, texture->data_pointer, SEEK_SET);
+    fread(sampler->encoded, texture->data_size, 1, file);
+
+    sampler->num_cached_tiles = num_cached_tiles;
+    sampler->cached_tiles = allocator_malloc(num_cached_tiles * sizeof(struct ctr_sampler_tile_t));
+    for (unsigned int i = 0; i < num_cached_tiles; i++)
+        sampler->cached_tiles[i].tile_index = -1;
+}
+
+void ctr_sampler_destroy(struct ctr_sampler_t *sampler)
+{
+    allocator_free(sampler->encoded);
+    allocator_free(sampler->cached_tiles);
+}
+
+const uint8_t *ctr_sampler_texel(struct ctr_sampler_t *sampler, unsigned int x, unsigned int y)
+{
+    const uint8_t *texels = ctr_sampler_tile(sampler, x / 8, y / 8);
+    return &texels[((y % 8) * 8 + x % 8) * 4];
+}
+
+/// Clamp the given pixel position to within the given size.
+/// @param position The position to clamp.
+/// @param size The size to clamp the given position within.
+/// @returns The given position, clamped between `0` and `size - 1`.
+unsigned int ctr_sampler_clamp(int position, unsigned int size)
+{
+    return position < 0 ? 0 : ((unsigned int)position >= size ? size - 1 : (unsigned int)position);
+}
+
+void ctr_sampler_sample_point(struct ctr_sampler_t *sampler, float u, float v, uint8_t *rgba)
+{
+    unsigned int width = sampler->texture->width;
+    unsigned int height = sampler->texture->height;
+    unsigned int x = ctr_sampler_clamp((int)floorf(u * width), width);
+    unsigned int y = ctr_sampler_clamp((int)floorf(v * height), height);
+    memcpy(rgba, ctr_sampler_texel(sampler, x, y), 4);
+}
+
+void ctr_sampler_sample_bilinear(struct ctr_sampler_t *sampler, float u, float v, uint8_t *rgba)
+{
+    unsigned int width = sampler->texture->width;
+    unsigned int height = sampler->texture->height;
+
+    // pixel centres are at half pixel offsets
+    float x = u * width - 0.5f;
+    float y = v * height - 0.5f;
+    float left = floorf(x);
+    float top = floorf(y);
+    float fraction_x = x - left;
+    float fraction_y = y - top;
+
+    unsigned int x0 = ctr_sampler_clamp((int)left, width);
+    unsigned int x1 = ctr_sampler_clamp((int)left + 1, width);
+    unsigned int y0 = ctr_sampler_clamp((int)top, height);
+    unsigned int y1 = ctr_sampler_clamp((int)top + 1, height);
+
+    // copy each texel out, as fetching one may evict the tile of another
+    uint8_t texels[4][4];
+    memcpy(texels[0], ctr_sampler_texel(sampler, x0, y0), 4);
+    memcpy(texels[1], ctr_sampler_texel(sampler, x1, y0), 4);
+    memcpy(texels[2], ctr_sampler_texel(sampler, x0, y1), 4);
+    memcpy(texels[3], ctr_sampler_texel(sampler, x1, y1), 4);
+
+    for (int c = 0; c < 4; c++)
+    {
+        float upper = texels[0][c] + (texels[1][c] - texels[0][c]) * fraction_x;
+        float lower = texels[2][c] + (texels[3][c] - texels[2][c]) * fraction_x;
+        rgba[c] = (uint8_t)(upper + (lower - upper) * fraction_y + 0.5f);
+    }
+}
+
+void ctr_sampler_fetch(struct ctr_sampler_t *sampler,
+                       unsigned int x,
+                       unsigned int y,
+                       unsigned int width,
+                       unsigned int height,
+                       uint8_t *out_rgba,
+                       size_t stride)
+{
+    assert(x + width <= sampler->texture->width && y + height <= sampler->texture->height);
+    if (width == 0 || height == 0)
+        return;
+
+    // copy the overlapping part of each tile in turn
+    for (unsigned int tile_y = y / 8; tile_y <= (y + height - 1) / 8; tile_y++)
+    {
+        unsigned int top = tile_y * 8 > y ? tile_y * 8 : y;
+        unsigned int bottom = (tile_y + 1) * 8 < y + height ? (tile_y + 1) * 8 : y + height;
+        for (unsigned int tile_x = x / 8; tile_x <= (x + width - 1) / 8; tile_x++)
+        {
+            unsigned int left = tile_x * 8 > x ? tile_x * 8 : x;
+            unsigned int right = (tile_x + 1) * 8 < x + width ? (tile_x + 1) * 8 : x + width;
+
+            const uint8_t *texels = ctr_sampler_tile(sampler, tile_x, tile_y);
+            for (unsigned int row = top; row < bottom; row++)
+                memcpy(&out_rgba[(row - y) * stride + (left - x) * 4],
+                       &texels[((row % 8) * 8 + left % 8) * 4],
+                       (right - left) * 4);
+        }
+    }
+}
@@ -10,8 +10,11 @@
 
 #include <string.h>
 #include <math.h>
+#include <assert.h>
 
+#include "allocator.h"
 #include "etcdec.h"
+#include "utils.h"
 
 // MARK: - Constants
 
@@ -89,6 +92,9 @@ void ctr_texture_create(unsigned int width,
     texture->data_format = data_format;
     texture->decoded_data_size = decoded_data_size;
     texture->unpacked_data_size = width * height * 4;
+    texture->num_levels = 1;
+    atomic_init(&texture->data_hash, 0);
+    atomic_init(&texture->data_hashed, 0);
 }
 
 uint8_t *ctr_texture_decode(const struct ctr_texture_t *texture, FILE *file)
@@ -115,7 +121,7 @@ uint8_t *ctr_texture_decode(const struct ctr_texture_t *texture, FILE *file)
                     for (int k = 0; k < 4; k++)
                         temp[(i * 64 + j) * 4 + k] = raw_data[(i * 64 + ctr_texture_translation_bytes[j]) * 4 + 3 - k];
 
-            uint8_t *decoded = malloc(texture->decoded_data_size);
+            uint8_t *decoded = allocator_malloc(texture->decoded_data_size);
             for (int i = 0; i < h; i++)
                 for (int j = 0; j < w; j++)
                     for (int k = 0; k < 4; k++)
@@ -131,7 +137,7 @@ uint8_t *ctr_texture_decode(const struct ctr_texture_t *texture, FILE *file)
                     for (int k = 0; k < 3; k++)
                         temp[(i * 64 + j) * 3 + k] = raw_data[(i * 64 + ctr_texture_translation_bytes[j]) * 3 + 2 - k];
 
-            uint8_t *decoded = malloc(texture->decoded_data_size);
+            uint8_t *decoded = allocator_malloc(texture->decoded_data_size);
             for (int i = 0; i < h; i++)
                 for (int j = 0; j < w; j++)
                     for (int k = 0; k < 3; k++)
@@ -149,7 +155,7 @@ uint8_t *ctr_texture_decode(const struct ctr_texture_t *texture, FILE *file)
                     for (int k = 0; k < 2; k++)
                         temp[(i * 64 + j) * 2 + k] = raw_data[(i * 64 + ctr_texture_translation_bytes[j]) * 2 + k];
 
-            uint8_t *decoded = malloc(texture->decoded_data_size);
+            uint8_t *decoded = allocator_malloc(texture->decoded_data_size);
             for (int i = 0; i < h; i++)
                 for (int j = 0; j < w; j++)
                     for (int k = 0; k < 2; k++)
@@ -166,7 +172,7 @@ uint8_t *ctr_texture_decode(const struct ctr_texture_t *texture, FILE *file)
                     for (int k = 0; k < 2; k++)
                         temp[(i * 64 + j) * 2 + k] = raw_data[(i * 64 + ctr_texture_translation_bytes[j]) * 2 + 1 - k];
 
-            uint8_t *decoded = malloc(texture->decoded_data_size);
+            uint8_t *decoded = allocator_malloc(texture->decoded_data_size);
             for (int i = 0; i < h; i++)
                 for (int j = 0; j < w; j++)
                     for (int k = 0; k < 2; k++)
@@ -183,7 +189,7 @@ uint8_t *ctr_texture_decode(const struct ctr_texture_t *texture, FILE *file)
                 for (int j = 0; j < 64; j++)
                     temp[i * 64 + j] = raw_data[i * 64 + ctr_texture_translation_bytes[j]];
 
-            uint8_t *decoded = malloc(texture->decoded_data_size);
+            uint8_t *decoded = allocator_malloc(texture->decoded_data_size);
             for (int i = 0; i < h; i++)
                 for (int j = 0; j < w; j++)
                     decoded[i * w + j] = temp[((i / 8) * (w / 8) + j / 8) * 64 + i % 8 * 8 + j % 8];
@@ -203,7 +209,7 @@ uint8_t *ctr_texture_decode(const struct ctr_texture_t *texture, FILE *file)
                 }
             }
 
-            uint8_t *decoded = malloc(texture->decoded_data_size);
+            uint8_t *decoded = allocator_malloc(texture->decoded_data_size);
             for (int i = 0; i < h; i++)
                 for (int j = 0; j < w; j++)
                     decoded[i * w + j] = temp[((i / 8) * (w / 8) + j / 8) * 64 + i % 8 * 8 + j % 8];
@@ -223,7 +229,7 @@ uint8_t *ctr_texture_decode(const struct ctr_texture_t *texture, FILE *file)
                     memcpy(compressed + ((i / 4) * (w / 4) + j / 4) * 8, temp + (((i / 8) * (w / 8) + j / 8) * 4 + (i % 8 / 4 * 2 + j % 8 / 4)) * 8, 8);
 
             int offset = 0;
-            uint8_t *decoded = malloc(texture->decoded_data_size);
+            uint8_t *decoded = allocator_malloc(texture->decoded_data_size);
             for (int y = 0; y < h / 4; y++)
             {
                 for (int x = 0; x < w / 4; x++)
@@ -277,7 +283,7 @@ uint8_t *ctr_texture_decode(const struct ctr_texture_t *texture, FILE *file)
                 }
             }
 
-            uint8_t *decoded = malloc(texture->decoded_data_size);
+            uint8_t *decoded = allocator_malloc(texture->decoded_data_size);
             for (int i = 0; i < w * h; i++)
             {
                 int rgb_index = i * 3;
@@ -312,14 +318,12 @@ uint8_t ctr_texture_un_to_u8(uint8_t un, unsigned int size)
 /// @param pixel The index of the pixel to unpack.
 /// @param format The data format of the given decoded data.
 /// @param decoded The array containing the decoded data to unpack.
-/// @param unpacked The 8-bit RGBA array to write the unpacked data to.
+/// @param unpacked The 4 bytes to write the unpacked 8-bit red, green, blue, and alpha channels of the pixel to.
 void ctr_texture_pixel_unpack(unsigned int pixel,
                               enum ctr_texture_format_t format,
                               const uint8_t *decoded,
                               uint8_t *unpacked)
 {
-    unsigned int unpacked_offset = pixel * 4;
-
     // get the red, green, blue, and alpha channels
     uint8_t red, green, blue, alpha;
     switch (format)
@@ -329,8 +333,8 @@ void ctr_texture_pixel_unpack(unsigned int pixel,
         {
             unsigned int decoded_offset = pixel * 4;
             red   = decoded[decoded_offset + 0];
-            blue  = decoded[decoded_offset + 1];
-            green = decoded[decoded_offset + 2];
+            green = decoded[decoded_offset + 1];
+            blue  = decoded[decoded_offset + 2];
             alpha = decoded[decoded_offset + 3];
             break;
         }
@@ -339,8 +343,8 @@ void ctr_texture_pixel_unpack(unsigned int pixel,
         {
             unsigned int decoded_offset = pixel * 3;
             red   = decoded[decoded_offset + 0];
-            blue  = decoded[decoded_offset + 1];
-            green = decoded[decoded_offset + 2];
+            green = decoded[decoded_offset + 1];
+            blue  = decoded[decoded_offset + 2];
             alpha = 0xff;
             break;
         }
@@ -366,8 +370,8 @@ void ctr_texture_pixel_unpack(unsigned int pixel,
         {
             uint16_t value = ((uint16_t *)decoded)[pixel];
             red   = ctr_texture_un_to_u8((value >> 12) & 0b1111, 4);
-            green = ctr_texture_un_to_u8((value >> 4) & 0b1111, 4);
-            blue  = ctr_texture_un_to_u8((value >> 8) & 0b1111, 4);
+            green = ctr_texture_un_to_u8((value >> 8) & 0b1111, 4);
+            blue  = ctr_texture_un_to_u8((value >> 4) & 0b1111, 4);
             alpha = ctr_texture_un_to_u8((value >> 0) & 0b1111, 4);
             break;
         }
@@ -422,30 +426,734 @@ void ctr_texture_pixel_unpack(unsigned int pixel,
     }
 
     // set the channels
-    unpacked[unpacked_offset + 0] = red;
-    unpacked[unpacked_offset + 1] = blue;
-    unpacked[unpacked_offset + 2] = green;
-    unpacked[unpacked_offset + 3] = alpha;
+    unpacked[0] = red;
+    unpacked[1] = green;
+    unpacked[2] = blue;
+    unpacked[3] = alpha;
+}
+
+/// Reduce the given 8-bit channel to the given number of bits, rounding to the nearest value.
+/// @param u8 The channel to reduce.
+/// @param size The bit size to reduce the given channel to.
+/// @returns The reduced value of the given channel.
+uint16_t ctr_texture_u8_to_un(uint8_t u8, unsigned int size)
+{
+    unsigned int max = (1 << size) - 1;
+    return (u8 * max + UINT8_MAX / 2) / UINT8_MAX;
+}
+
+/// Pack the given unpacked pixel into the given format.
+/// @param rgba The unpacked 8-bit red, green, blue, and alpha channels of the pixel.
+/// @param data_format The data format of the texture that the given pixel is from.
+/// @param format The format to pack the pixel into.
+/// @param packed The bytes to write the packed pixel to, of the size of a single pixel of the given format.
+void ctr_texture_pixel_pack(const uint8_t *rgba,
+                            enum ctr_texture_format_t data_format,
+                            enum ctr_texture_unpack_format_t format,
+                            uint8_t *packed)
+{
+    int alpha_only = data_format == CTR_TEXTURE_FORMAT_A8 || data_format == CTR_TEXTURE_FORMAT_A4;
+    int luminance_alpha = data_format == CTR_TEXTURE_FORMAT_LA88 || data_format == CTR_TEXTURE_FORMAT_LA44 ||
+                          data_format == CTR_TEXTURE_FORMAT_L8 || data_format == CTR_TEXTURE_FORMAT_L4;
+
+    switch (format)
+    {
+        case CTR_TEXTURE_UNPACK_FORMAT_RGBA8888:
+        {
+            memcpy(packed, rgba, 4);
+            break;
+        }
+        case CTR_TEXTURE_UNPACK_FORMAT_RGB565:
+        {
+            uint16_t value = ctr_texture_u8_to_un(rgba[0], 5) << 11 |
+                             ctr_texture_u8_to_un(rgba[1], 6) << 5 |
+                             ctr_texture_u8_to_un(rgba[2], 5);
+            memcpy(packed, &value, sizeof(value));
+            break;
+        }
+        case CTR_TEXTURE_UNPACK_FORMAT_RGBA4444:
+        {
+            uint16_t value = ctr_texture_u8_to_un(rgba[0], 4) << 12 |
+                             ctr_texture_u8_to_un(rgba[1], 4) << 8 |
+                             ctr_texture_u8_to_un(rgba[2], 4) << 4 |
+                             ctr_texture_u8_to_un(rgba[3], 4);
+            memcpy(packed, &value, sizeof(value));
+            break;
+        }
+        case CTR_TEXTURE_UNPACK_FORMAT_R8:
+        {
+            packed[0] = alpha_only ? rgba[3] : rgba[0];
+            break;
+        }
+        case CTR_TEXTURE_UNPACK_FORMAT_RG8:
+        {
+            packed[0] = rgba[0];
+            packed[1] = (alpha_only || luminance_alpha) ? rgba[3] : rgba[1];
+            break;
+        }
+    }
+}
+
+/// Rescale an unsigned integer of a variable bit size to another bit size, rounding to the nearest value.
+/// @param un The value to rescale.
+/// @param size The bit size of the given value.
+/// @param new_size The bit size to rescale the given value to.
+/// @returns The rescaled value of the given value.
+uint16_t ctr_texture_un_to_un(uint16_t un, unsigned int size, unsigned int new_size)
+{
+    unsigned int max = (1 << size) - 1;
+    unsigned int new_max = (1 << new_size) - 1;
+    return (un * new_max + max / 2) / max;
+}
+
+/// Pack a pixel from decoded 16-bit CTR texture data directly into a 16-bit format, without going through 8-bit channels.
+///
+/// This keeps native 16-bit pixels exact when they are unpacked to their own format,
+/// and rounds each channel only once when they are unpacked to another 16-bit format.
+/// @param pixel The index of the pixel to pack.
+/// @param data_format The data format of the given decoded data.
+/// @param decoded The array containing the decoded data to pack.
+/// @param format The format to pack the pixel into.
+/// @param swap_red_blue Whether or not to swap the red and blue channels of the pixel.
+/// @param packed The bytes to write the packed pixel to, of the size of a single pixel of the given format.
+/// @returns Whether or not the pixel was packed.
+/// This is only possible for RGB565, RGBA5551, and RGBA4444 data packed into RGB565 or RGBA4444.
+int ctr_texture_pixel_pack_native(unsigned int pixel,
+                                  enum ctr_texture_format_t data_format,
+                                  const uint8_t *decoded,
+                                  enum ctr_texture_unpack_format_t format,
+                                  int swap_red_blue,
+                                  uint8_t *packed)
+{
+    if (format != CTR_TEXTURE_UNPACK_FORMAT_RGB565 && format != CTR_TEXTURE_UNPACK_FORMAT_RGBA4444)
+        return 0;
+    if (data_format != CTR_TEXTURE_FORMAT_RGB565 &&
+        data_format != CTR_TEXTURE_FORMAT_RGBA5551 &&
+        data_format != CTR_TEXTURE_FORMAT_RGBA4444)
+        return 0;
+
+    // get the red, green, blue, and alpha fields and their bit sizes
+    uint16_t value = ((const uint16_t *)decoded)[pixel];
+    uint16_t red, green, blue, alpha;
+    unsigned int red_size, green_size, blue_size, alpha_size;
+    switch (data_format)
+    {
+        case CTR_TEXTURE_FORMAT_RGB565:
+            red   = (value >> 11) & 0b11111;  red_size = 5;
+            green = (value >> 5) & 0b111111;  green_size = 6;
+            blue  = value & 0b11111;          blue_size = 5;
+            alpha = 1;                        alpha_size = 1;
+            break;
+        case CTR_TEXTURE_FORMAT_RGBA5551:
+            red   = (value >> 11) & 0b11111;  red_size = 5;
+            green = (value >> 6) & 0b11111;   green_size = 5;
+            blue  = (value >> 1) & 0b11111;   blue_size = 5;
+            alpha = value & 0b1;              alpha_size = 1;
+            break;
+        case CTR_TEXTURE_FORMAT_RGBA4444:
+            red   = (value >> 12) & 0b1111;   red_size = 4;
+            green = (value >> 8) & 0b1111;    green_size = 4;
+            blue  = (value >> 4) & 0b1111;    blue_size = 4;
+            alpha = value & 0b1111;           alpha_size = 4;
+            break;
+        default:
+            // should never be reached
+            assert(0);
+    }
+
+    if (swap_red_blue)
+    {
+        uint16_t swapped = red;
+        red = blue;
+        blue = swapped;
+    }
+
+    uint16_t packed_value;
+    if (format == CTR_TEXTURE_UNPACK_FORMAT_RGB565)
+    {
+        packed_value = ctr_texture_un_to_un(red, red_size, 5) << 11 |
+                       ctr_texture_un_to_un(green, green_size, 6) << 5 |
+                       ctr_texture_un_to_un(blue, blue_size, 5);
+    }
+    else
+    {
+        packed_value = ctr_texture_un_to_un(red, red_size, 4) << 12 |
+                       ctr_texture_un_to_un(green, green_size, 4) << 8 |
+                       ctr_texture_un_to_un(blue, blue_size, 4) << 4 |
+                       ctr_texture_un_to_un(alpha, alpha_size, 4);
+    }
+
+    memcpy(packed, &packed_value, sizeof(packed_value));
+    return 1;
+}
+
+uint64_t ctr_texture_hash(struct ctr_texture_t *texture, FILE *file)
+{
+    if (atomic_load_explicit(&texture->data_hashed, memory_order_acquire))
+        return atomic_load_explicit(&texture->data_hash, memory_order_relaxed);
+
+    // threads racing to hash the same texture all compute the same value, so whichever publishes last is harmless
+    uint8_t *raw_data = allocator_malloc(texture->data_size);
+    flockfile(file);
+    fseek(file, texture->data_pointer, SEEK_SET);
+    fread(raw_data, texture->data_size, 1, file);
+    funlockfile(file);
+
+    uint64_t hash = utils_hash64(raw_data, texture->data_size);
+    allocator_free(raw_data);
+
+    atomic_store_explicit(&texture->data_hash, hash, memory_order_relaxed);
+    atomic_store_explicit(&texture->data_hashed, 1, memory_order_release);
+    return hash;
 }
 
 uint8_t *ctr_texture_unpack(const struct ctr_texture_t *texture,
                             const uint8_t *decoded)
+{
+    return ctr_texture_unpack_format(texture, decoded, CTR_TEXTURE_UNPACK_FORMAT_RGBA8888);
+}
+
+size_t ctr_texture_unpacked_size(const struct ctr_texture_t *texture, enum ctr_texture_unpack_format_t format)
+{
+    size_t pixel_size = 4;
+    switch (format)
+    {
+        case CTR_TEXTURE_UNPACK_FORMAT_RGBA8888: pixel_size = 4; break;
+        case CTR_TEXTURE_UNPACK_FORMAT_RGB565:
+        case CTR_TEXTURE_UNPACK_FORMAT_RGBA4444:
+        case CTR_TEXTURE_UNPACK_FORMAT_RG8:      pixel_size = 2; break;
+        case CTR_TEXTURE_UNPACK_FORMAT_R8:       pixel_size = 1; break;
+    }
+
+    return (size_t)texture->width * texture->height * pixel_size;
+}
+
+uint8_t *ctr_texture_unpack_format(const struct ctr_texture_t *texture,
+                                   const uint8_t *decoded,
+                                   enum ctr_texture_unpack_format_t format)
 {
     // unpack the decoded data
-    // width * height * 4 channels (rgba)
-    uint8_t *unpacked = malloc(texture->unpacked_data_size);
+    size_t pixel_size = ctr_texture_unpacked_size(texture, format) / ((size_t)texture->width * texture->height);
+    uint8_t *unpacked = allocator_malloc(ctr_texture_unpacked_size(texture, format));
 
     for (int y = 0; y < texture->height; y++)
     {
         for (int x = 0; x < texture->width; x++)
         {
             int pixel = (y * texture->width) + x;
-            ctr_texture_pixel_unpack(pixel,
-                                     texture->data_format,
-                                     decoded,
-                                     unpacked);
+            if (!ctr_texture_pixel_pack_native(pixel, texture->data_format, decoded, format, 0, &unpacked[pixel * pixel_size]))
+            {
+                uint8_t rgba[4];
+                ctr_texture_pixel_unpack(pixel,
+                                         texture->data_format,
+                                         decoded,
+                                         rgba);
+
+                ctr_texture_pixel_pack(rgba, texture->data_format, format, &unpacked[pixel * pixel_size]);
+            }
         }
     }
 
     return unpacked;
 }
+
+/// Unpack the given decoded texel, apply the given options to it, and write it to the given position within the given unpacked data.
+/// @param texel The decoded data of the texel, in the same format as a single pixel from `ctr_texture_decode(texture, file)`.
+/// @param data_format The data format of the texture that the given texel is from.
+/// @param options The options to apply to the texel.
+/// @param x The X position to write the texel to, in pixels.
+/// @param y The Y position to write the texel to, in pixels, from the top of the unpacked data.
+/// @param width The width of the unpacked data, in pixels.
+/// @param height The height of the unpacked data, in pixels.
+/// @param pixel_size The size of a single pixel of the unpacked data, in bytes.
+/// @param unpacked The unpacked data to write the texel to.
+void ctr_texture_texel_unpack(const uint8_t *texel,
+                              enum ctr_texture_format_t data_format,
+                              const struct ctr_texture_unpack_options_t *options,
+                              unsigned int x,
+                              unsigned int y,
+                              unsigned int width,
+                              unsigned int height,
+                              size_t pixel_size,
+                              uint8_t *unpacked)
+{
+    unsigned int row = options->flipped ? height - 1 - y : y;
+    uint8_t *packed = &unpacked[((size_t)row * width + x) * pixel_size];
+
+    // 16-bit pixels only go through 8-bit channels when they need to be premultiplied
+    int swap_red_blue = options->channel_order == CTR_TEXTURE_CHANNEL_ORDER_BGRA;
+    if (!options->premultiplied &&
+        ctr_texture_pixel_pack_native(0, data_format, texel, options->format, swap_red_blue, packed))
+        return;
+
+    uint8_t rgba[4];
+    ctr_texture_pixel_unpack(0, data_format, texel, rgba);
+
+    if (options->premultiplied)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            // divide by 255 with rounding
+            unsigned int value = rgba[c] * rgba[3] + 128;
+            rgba[c] = (value + (value >> 8)) >> 8;
+        }
+    }
+
+    if (swap_red_blue &&
+        options->format != CTR_TEXTURE_UNPACK_FORMAT_R8 &&
+        options->format != CTR_TEXTURE_UNPACK_FORMAT_RG8)
+    {
+        uint8_t red = rgba[0];
+        rgba[0] = rgba[2];
+        rgba[2] = red;
+    }
+
+    ctr_texture_pixel_pack(rgba, data_format, options->format, packed);
+}
+
+/// Decode and unpack a single 8x8 tile of the given CTR texture's encoded data, writing it to the given position within the given unpacked data.
+/// @param texture The CTR texture that the given encoded data is of.
+/// @param raw_data The encoded data of the entire texture.
+/// @param tile_x The X position of the tile to unpack, in tiles.
+/// @param tile_y The Y position of the tile to unpack, in tiles.
+/// @param options The options to apply to each texel of the tile.
+/// @param x The X position to write the top left texel of the tile to, in pixels.
+/// @param y The Y position to write the top left texel of the tile to, in pixels, from the top of the unpacked data.
+/// @param width The width of the unpacked data, in pixels.
+/// @param height The height of the unpacked data, in pixels.
+/// @param unpacked The unpacked data to write the tile to.
+void ctr_texture_tile_unpack(const struct ctr_texture_t *texture,
+                             const uint8_t *raw_data,
+                             unsigned int tile_x,
+                             unsigned int tile_y,
+                             const struct ctr_texture_unpack_options_t *options,
+                             unsigned int x,
+                             unsigned int y,
+                             unsigned int width,
+                             unsigned int height,
+                             uint8_t *unpacked)
+{
+    size_t pixel_size = ctr_texture_unpacked_size(texture, options->format) / ((size_t)texture->width * texture->height);
+    unsigned int tile = tile_y * (texture->width / 8) + tile_x;
+
+    // get the size of each texel, and whether or not it's bytes are reversed
+    size_t texel_size = 0;
+    int reversed = 0;
+    switch (texture->data_format)
+    {
+        case CTR_TEXTURE_FORMAT_RGBA8888: texel_size = 4; reversed = 1; break;
+        case CTR_TEXTURE_FORMAT_RGB888:   texel_size = 3; reversed = 1; break;
+        case CTR_TEXTURE_FORMAT_RGBA5551:
+        case CTR_TEXTURE_FORMAT_RGB565:
+        case CTR_TEXTURE_FORMAT_RGBA4444: texel_size = 2; reversed = 0; break;
+        case CTR_TEXTURE_FORMAT_LA88:
+        case CTR_TEXTURE_FORMAT_HL8:      texel_size = 2; reversed = 1; break;
+        case CTR_TEXTURE_FORMAT_L8:
+        case CTR_TEXTURE_FORMAT_A8:
+        case CTR_TEXTURE_FORMAT_LA44:     texel_size = 1; reversed = 0; break;
+        case CTR_TEXTURE_FORMAT_L4:
+        case CTR_TEXTURE_FORMAT_A4:
+        case CTR_TEXTURE_FORMAT_ETC1:
+        case CTR_TEXTURE_FORMAT_ETC1_A4:  break;
+    }
+
+    switch (texture->data_format)
+    {
+        case CTR_TEXTURE_FORMAT_ETC1:
+        case CTR_TEXTURE_FORMAT_ETC1_A4:
+        {
+            // each tile contains four 4x4 blocks, ordered top left, top right, bottom left, then bottom right
+            int has_alpha = texture->data_format == CTR_TEXTURE_FORMAT_ETC1_A4;
+            size_t block_stride = has_alpha ? 16 : 8;
+            for (unsigned int b = 0; b < 4; b++)
+            {
+                const uint8_t *source = &raw_data[(tile * 4 + b) * block_stride];
+                const uint8_t *colour = source + (has_alpha ? 8 : 0);
+
+                uint8_t block[8];
+                for (int i = 0; i < 8; i++)
+                    block[i] = colour[7 - i];
+
+                uint8_t rgb[4 * 4 * 3];
+                ctr_texture_etc1_block_decode(block, rgb);
+
+                for (unsigned int block_y = 0; block_y < 4; block_y++)
+                {
+                    for (unsigned int block_x = 0; block_x < 4; block_x++)
+                    {
+                        uint8_t texel[4];
+                        memcpy(texel, &rgb[(block_y * 4 + block_x) * 3], 3);
+
+                        // the alpha is column major, with two rows per byte and the upper row in the low bits
+                        if (has_alpha)
+                            texel[3] = ((source[block_x * 2 + block_y / 2] >> (block_y % 2 * 4)) & 0xf) * 0x11;
+
+                        ctr_texture_texel_unpack(texel,
+                                                 texture->data_format,
+                                                 options,
+                                                 x + b % 2 * 4 + block_x,
+                                                 y + b / 2 * 4 + block_y,
+                                                 width,
+                                                 height,
+                                                 pixel_size,
+                                                 unpacked);
+                    }
+                }
+            }
+
+            break;
+        }
+        case CTR_TEXTURE_FORMAT_L4:
+        case CTR_TEXTURE_FORMAT_A4:
+        {
+            for (unsigned int j = 0; j < 64; j++)
+            {
+                uint8_t texel = ((raw_data[tile * 32 + ctr_texture_translation_bytes[j] / 2] >> (j % 2 * 4)) & 0xf) * 0x11;
+                ctr_texture_texel_unpack(&texel,
+                                         texture->data_format,
+                                         options,
+                                         x + j % 8,
+                                         y + j / 8,
+                                         width,
+                                         height,
+                                         pixel_size,
+                                         unpacked);
+            }
+
+            break;
+        }
+        default:
+        {
+            for (unsigned int j = 0; j < 64; j++)
+            {
+                const uint8_t *source = &raw_data[(tile * 64 + ctr_texture_translation_bytes[j]) * texel_size];
+                uint8_t texel[4];
+                for (size_t k = 0; k < texel_size; k++)
+                    texel[k] = source[reversed ? texel_size - 1 - k : k];
+
+                ctr_texture_texel_unpack(texel,
+                                         texture->data_format,
+                                         options,
+                                         x + j % 8,
+                                         y + j / 8,
+                                         width,
+                                         height,
+                                         pixel_size,
+                                         unpacked);
+            }
+
+            break;
+        }
+    }
+}
+
+uint8_t *ctr_texture_decode_unpacked(const struct ctr_texture_t *texture,
+                                     FILE *file,
+                                     const struct ctr_texture_unpack_options_t *options)
+{
+    // read the data to decode
+    uint8_t *raw_data = allocator_malloc(texture->data_size);
+    fseek(file, texture->data_pointer, SEEK_SET);
+    fread(raw_data, texture->data_size, 1, file);
+
+    uint8_t *unpacked = ctr_texture_decode_unpacked_encoded(texture, raw_data, options);
+    allocator_free(raw_data);
+    return unpacked;
+}
+
+uint8_t *ctr_texture_decode_unpacked_encoded(const struct ctr_texture_t *texture,
+                                             const uint8_t *encoded,
+                                             const struct ctr_texture_unpack_options_t *options)
+{
+    // each tile is 8x8 pixels, ordered left to right then top to bottom
+    unsigned int w = texture->width;
+    unsigned int h = texture->height;
+    uint8_t *unpacked = allocator_malloc(ctr_texture_unpacked_size(texture, options->format));
+    for (unsigned int tile_y = 0; tile_y < h / 8; tile_y++)
+        for (unsigned int tile_x = 0; tile_x < w / 8; tile_x++)
+            ctr_texture_tile_unpack(texture, encoded, tile_x, tile_y, options, tile_x * 8, tile_y * 8, w, h, unpacked);
+
+    return unpacked;
+}
+
+void ctr_texture_decode_tile(const struct ctr_texture_t *texture,
+                             const uint8_t *encoded,
+                             unsigned int tile_x,
+                             unsigned int tile_y,
+                             uint8_t *unpacked)
+{
+    struct ctr_texture_unpack_options_t options =
+    {
+        .format = CTR_TEXTURE_UNPACK_FORMAT_RGBA8888,
+        .channel_order = CTR_TEXTURE_CHANNEL_ORDER_RGBA,
+        .premultiplied = 0,
+        .flipped = 0,
+    };
+
+    ctr_texture_tile_unpack(texture, encoded, tile_x, tile_y, &options, 0, 0, 8, 8, unpacked);
+}
+
+void ctr_texture_etc1_block_decode(const uint8_t *block, uint8_t *rgb)
+{
+    int offset = 0;
+    uint32_t block1 = ctr_texture_etc_read_word(block, &offset);
+    uint32_t block2 = ctr_texture_etc_read_word(block, &offset);
+    decompressBlockETC2(block1, block2, rgb, 4, 4, 0, 0);
+}
+
+/// Get the sum of each colour channel across all sixteen pixels of the given ETC1 block, without decoding the pixels.
+///
+/// Only the number of pixels using each modifier of each sub-block is counted,
+/// so the sums are exact while costing a fraction of decoding.
+/// @param block The 8 bytes of the ETC1 block, in standard big endian order.
+/// @param sums The 3 sums to write, for the red, green, and blue channels.
+/// @returns Whether or not the sums were written.
+/// This fails for differential blocks whose second base colour overflows,
+/// which are decoded as one of the ETC2 modes instead and must be decoded fully.
+int ctr_texture_etc1_block_sum(const uint8_t *block, unsigned int *sums)
+{
+    int offset = 0;
+    uint32_t high = ctr_texture_etc_read_word(block, &offset);
+    uint32_t low = ctr_texture_etc_read_word(block, &offset);
+    int differential = (high >> 1) & 1;
+    int flipped = high & 1;
+
+    // read the base colour of each sub-block
+    int bases[2][3];
+    for (int c = 0; c < 3; c++)
+    {
+        int shift = 24 - c * 8;
+        if (differential)
+        {
+            int base = (high >> (shift + 3)) & 0x1f;
+            int delta = (int)((high >> shift) & 0x7);
+            int other = base + (delta >= 4 ? delta - 8 : delta);
+            if (other < 0 || other > 31)
+                return 0;
+
+            bases[0][c] = (base << 3) | (base >> 2);
+            bases[1][c] = (other << 3) | (other >> 2);
+        }
+        else
+        {
+            bases[0][c] = ((high >> (shift + 4)) & 0xf) * 0x11;
+            bases[1][c] = ((high >> shift) & 0xf) * 0x11;
+        }
+    }
+
+    // count the pixels using each modifier of each sub-block
+    // the pixel indices are column major, with the high bits of every index before the low bits
+    unsigned int counts[2][4] = { { 0, 0, 0, 0 }, { 0, 0, 0, 0 } };
+    for (int x = 0; x < 4; x++)
+    {
+        for (int y = 0; y < 4; y++)
+        {
+            int bit = x * 4 + y;
+            int index = ((low >> (bit + 16)) & 1) << 1 | ((low >> bit) & 1);
+            counts[flipped ? y >= 2 : x >= 2][index]++;
+        }
+    }
+
+    const int tables[2] = { (high >> 5) & 0x7, (high >> 2) & 0x7 };
+    for (int c = 0; c < 3; c++)
+    {
+        sums[c] = 0;
+        for (int s = 0; s < 2; s++)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                int value = bases[s][c] + compressParams[tables[s] * 2][unscramble[i]];
+                sums[c] += counts[s][i] * (value < 0 ? 0 : (value > 255 ? 255 : value));
+            }
+        }
+    }
+
+    return 1;
+}
+
+uint8_t *ctr_texture_decode_scaled(const struct ctr_texture_t *texture, FILE *file, unsigned int divisor)
+{
+    assert(divisor == 2 || divisor == 4 || divisor == 8);
+
+    // read the data to decode
+    uint8_t *raw_data = allocator_malloc(texture->data_size);
+    fseek(file, texture->data_pointer, SEEK_SET);
+    fread(raw_data, texture->data_size, 1, file);
+
+    unsigned int w = texture->width;
+    unsigned int h = texture->height;
+    unsigned int scaled_width = w / divisor;
+    unsigned int tile_size = 8 / divisor;
+    unsigned int area = divisor * divisor;
+    uint8_t *scaled = allocator_malloc((size_t)scaled_width * (h / divisor) * 4);
+
+    struct ctr_texture_unpack_options_t options =
+    {
+        .format = CTR_TEXTURE_UNPACK_FORMAT_RGBA8888,
+        .channel_order = CTR_TEXTURE_CHANNEL_ORDER_RGBA,
+        .premultiplied = 0,
+        .flipped = 0,
+    };
+
+    int is_etc1 = texture->data_format == CTR_TEXTURE_FORMAT_ETC1 || texture->data_format == CTR_TEXTURE_FORMAT_ETC1_A4;
+    int has_alpha = texture->data_format == CTR_TEXTURE_FORMAT_ETC1_A4;
+    for (unsigned int tile_y = 0; tile_y < h / 8; tile_y++)
+    {
+        for (unsigned int tile_x = 0; tile_x < w / 8; tile_x++)
+        {
+            unsigned int tile = tile_y * (w / 8) + tile_x;
+            int reduced = 0;
+            if (is_etc1 && divisor == 4)
+            {
+                // each etc1 block maps to a single pixel, ordered top left, top right, bottom left, then bottom right
+                reduced = 1;
+                for (unsigned int b = 0; b < 4 && reduced; b++)
+                {
+                    const uint8_t *source = &raw_data[(tile * 4 + b) * (has_alpha ? 16 : 8)];
+                    uint8_t block[8];
+                    for (int i = 0; i < 8; i++)
+                        block[i] = source[(has_alpha ? 8 : 0) + 7 - i];
+
+                    unsigned int sums[4];
+                    reduced = ctr_texture_etc1_block_sum(block, sums);
+
+                    sums[3] = 16 * 0xff;
+                    if (has_alpha)
+                    {
+                        sums[3] = 0;
+                        for (int i = 0; i < 8; i++)
+                            sums[3] += ((source[i] & 0xf) + (source[i] >> 4)) * 0x11;
+                    }
+
+                    uint8_t *pixel = &scaled[((size_t)(tile_y * 2 + b / 2) * scaled_width + tile_x * 2 + b % 2) * 4];
+                    for (int c = 0; c < 4; c++)
+                        pixel[c] = (sums[c] + 8) / 16;
+                }
+            }
+
+            if (reduced)
+                continue;
+
+            // decode the tile, then average each square of it
+            uint8_t texels[8 * 8 * 4];
+            ctr_texture_tile_unpack(texture, raw_data, tile_x, tile_y, &options, 0, 0, 8, 8, texels);
+            for (unsigned int y = 0; y < tile_size; y++)
+            {
+                for (unsigned int x = 0; x < tile_size; x++)
+                {
+                    unsigned int sums[4] = { 0, 0, 0, 0 };
+                    for (unsigned int j = 0; j < divisor; j++)
+                        for (unsigned int i = 0; i < divisor; i++)
+                            for (int c = 0; c < 4; c++)
+                                sums[c] += texels[((y * divisor + j) * 8 + x * divisor + i) * 4 + c];
+
+                    uint8_t *pixel = &scaled[((size_t)(tile_y * tile_size + y) * scaled_width + tile_x * tile_size + x) * 4];
+                    for (int c = 0; c < 4; c++)
+                        pixel[c] = (sums[c] + area / 2) / area;
+                }
+            }
+        }
+    }
+
+    allocator_free(raw_data);
+    return scaled;
+}
+
+size_t ctr_texture_encoded_size(enum ctr_texture_format_t data_format, unsigned int width, unsigned int height)
+{
+    size_t bits_per_pixel = 32;
+    switch (data_format)
+    {
+        case CTR_TEXTURE_FORMAT_RGBA8888: bits_per_pixel = 32; break;
+        case CTR_TEXTURE_FORMAT_RGB888:   bits_per_pixel = 24; break;
+        case CTR_TEXTURE_FORMAT_RGBA5551:
+        case CTR_TEXTURE_FORMAT_RGB565:
+        case CTR_TEXTURE_FORMAT_RGBA4444:
+        case CTR_TEXTURE_FORMAT_LA88:
+        case CTR_TEXTURE_FORMAT_HL8:      bits_per_pixel = 16; break;
+        case CTR_TEXTURE_FORMAT_L8:
+        case CTR_TEXTURE_FORMAT_A8:
+        case CTR_TEXTURE_FORMAT_LA44:     bits_per_pixel = 8;  break;
+        case CTR_TEXTURE_FORMAT_L4:
+        case CTR_TEXTURE_FORMAT_A4:       bits_per_pixel = 4;  break;
+        case CTR_TEXTURE_FORMAT_ETC1:     bits_per_pixel = 4;  break;
+        case CTR_TEXTURE_FORMAT_ETC1_A4:  bits_per_pixel = 8;  break;
+    }
+
+    return (size_t)width * height * bits_per_pixel / 8;
+}
+
+void ctr_texture_level(const struct ctr_texture_t *texture, unsigned int level, struct ctr_texture_t *level_texture)
+{
+    assert(level < texture->num_levels);
+
+    // skip the data of every preceding level
+    unsigned int width = texture->width;
+    unsigned int height = texture->height;
+    size_t data_pointer = texture->data_pointer;
+    for (unsigned int i = 0; i < level; i++)
+    {
+        data_pointer += ctr_texture_encoded_size(texture->data_format, width, height);
+        width = width / 2 < 8 ? 8 : width / 2;
+        height = height / 2 < 8 ? 8 : height / 2;
+    }
+
+    ctr_texture_create(width,
+                       height,
+                       ctr_texture_encoded_size(texture->data_format, width, height),
+                       data_pointer,
+                       texture->data_format,
+                       level_texture);
+}
+
+uint8_t **ctr_texture_decode_levels(const struct ctr_texture_t *texture, FILE *file)
+{
+    uint8_t **levels = allocator_malloc(texture->num_levels * sizeof(uint8_t *));
+    for (unsigned int i = 0; i < texture->num_levels; i++)
+    {
+        struct ctr_texture_t level_texture;
+        ctr_texture_level(texture, i, &level_texture);
+        levels[i] = ctr_texture_decode(&level_texture, file);
+    }
+
+    return levels;
+}
+
+void ctr_texture_decode_rows(const struct ctr_texture_t *texture,
+                             FILE *file,
+                             const struct ctr_texture_unpack_options_t *options,
+                             void (*callback)(const uint8_t *rows,
+                                              unsigned int first_row,
+                                              unsigned int num_rows,
+                                              size_t stride,
+                                              void *context),
+                             void *context)
+{
+    unsigned int w = texture->width;
+    unsigned int h = texture->height;
+    size_t encoded_row_size = ctr_texture_encoded_size(texture->data_format, w, 8);
+    size_t unpacked_row_size = ctr_texture_unpacked_size(texture, options->format) / h * 8;
+    uint8_t *raw_row = allocator_malloc(encoded_row_size);
+    uint8_t *unpacked_row = allocator_malloc(unpacked_row_size);
+
+    // a row of tiles is a texture of it's own, with the tiles in the same order
+    struct ctr_texture_t row_texture;
+    ctr_texture_create(w, 8, encoded_row_size, 0, texture->data_format, &row_texture);
+
+    unsigned int num_tile_rows = h / 8;
+    for (unsigned int i = 0; i < num_tile_rows; i++)
+    {
+        // flipped rows are read bottom up, so they are still passed in output order
+        unsigned int tile_y = options->flipped ? num_tile_rows - 1 - i : i;
+        fseek(file, texture->data_pointer + tile_y * encoded_row_size, SEEK_SET);
+        fread(raw_row, encoded_row_size, 1, file);
+
+        for (unsigned int tile_x = 0; tile_x < w / 8; tile_x++)
+            ctr_texture_tile_unpack(&row_texture, raw_row, tile_x, 0, options, tile_x * 8, 0, w, 8, unpacked_row);
+
+        callback(unpacked_row, i * 8, 8, unpacked_row_size / 8, context);
+    }
+
+    allocator_free(raw_row);
+    allocator_free(unpacked_row);
+}
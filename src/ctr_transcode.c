@@ -0,0 +1,317 @@
+//
+//  ctr_transcode.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "ctr_transcode.h"
+
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include "allocator.h"
+#include "ctr_etc1.h"
+
+// MARK: - Functions
+
+/// Quantize the given colour to RGB565.
+/// @param red The red channel of the colour.
+/// @param green The green channel of the colour.
+/// @param blue The blue channel of the colour.
+/// @returns The given colour, quantized to RGB565.
+uint16_t ctr_transcode_rgb565(int red, int green, int blue)
+{
+    return (uint16_t)(((red * 31 + 127) / 255) << 11 | ((green * 63 + 127) / 255) << 5 | ((blue * 31 + 127) / 255));
+}
+
+/// Get the given channel of the given RGB565 colour, expanded to eight bits.
+/// @param colour The RGB565 colour.
+/// @param shift The offset of the channel within the given colour, in bits.
+/// @param bits The number of bits of the channel.
+/// @returns The expanded channel.
+int ctr_transcode_rgb565_channel(uint16_t colour, int shift, int bits)
+{
+    int value = (colour >> shift) & ((1 << bits) - 1);
+    return (value << (8 - bits)) | (value >> (2 * bits - 8));
+}
+
+void ctr_transcode_etc1_to_bc1(const uint8_t *etc1, uint8_t *bc1)
+{
+    // split the decoded block into separate channels, as every later pass works a channel at a time
+    uint8_t rgb[4 * 4 * 3];
+    ctr_texture_etc1_block_decode(etc1, rgb);
+
+    int red[16], green[16], blue[16];
+    for (int i = 0; i < 16; i++)
+    {
+        red[i] = rgb[i * 3 + 0];
+        green[i] = rgb[i * 3 + 1];
+        blue[i] = rgb[i * 3 + 2];
+    }
+
+    // find the principal axis of the pixels, then take the endpoints from the pixels furthest along it
+    int mean[3] = { 0, 0, 0 };
+    for (int i = 0; i < 16; i++)
+    {
+        mean[0] += red[i];
+        mean[1] += green[i];
+        mean[2] += blue[i];
+    }
+
+    float covariance[6] = { 0, 0, 0, 0, 0, 0 };
+    for (int i = 0; i < 16; i++)
+    {
+        float r = red[i] - mean[0] / 16.0f;
+        float g = green[i] - mean[1] / 16.0f;
+        float b = blue[i] - mean[2] / 16.0f;
+        covariance[0] += r * r;
+        covariance[1] += r * g;
+        covariance[2] += r * b;
+        covariance[3] += g * g;
+        covariance[4] += g * b;
+        covariance[5] += b * b;
+    }
+
+    // etc1 modifiers move every channel equally, so grey is a good starting direction
+    float direction[3] = { 1, 1, 1 };
+    for (int iteration = 0; iteration < 4; iteration++)
+    {
+        float r = direction[0] * covariance[0] + direction[1] * covariance[1] + direction[2] * covariance[2];
+        float g = direction[0] * covariance[1] + direction[1] * covariance[3] + direction[2] * covariance[4];
+        float b = direction[0] * covariance[2] + direction[1] * covariance[4] + direction[2] * covariance[5];
+        float magnitude = fmaxf(fabsf(r), fmaxf(fabsf(g), fabsf(b)));
+        if (magnitude == 0)
+            break;
+
+        direction[0] = r / magnitude;
+        direction[1] = g / magnitude;
+        direction[2] = b / magnitude;
+    }
+
+    float projections[16];
+    int i = 0;
+#if defined(__SSE2__)
+    // four pixels at a time
+    const __m128 direction_red = _mm_set1_ps(direction[0]);
+    const __m128 direction_green = _mm_set1_ps(direction[1]);
+    const __m128 direction_blue = _mm_set1_ps(direction[2]);
+    for (; i < 16; i += 4)
+    {
+        __m128 r = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)&red[i])), direction_red);
+        __m128 g = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)&green[i])), direction_green);
+        __m128 b = _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)&blue[i])), direction_blue);
+        _mm_storeu_ps(&projections[i], _mm_add_ps(_mm_add_ps(r, g), b));
+    }
+#elif defined(__ARM_NEON)
+    // four pixels at a time
+    for (; i < 16; i += 4)
+    {
+        float32x4_t r = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(&red[i])), direction[0]);
+        float32x4_t g = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(&green[i])), direction[1]);
+        float32x4_t b = vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(&blue[i])), direction[2]);
+        vst1q_f32(&projections[i], vaddq_f32(vaddq_f32(r, g), b));
+    }
+#endif
+
+    // the remaining pixels, or all of them without vector support
+    for (; i < 16; i++)
+        projections[i] = red[i] * direction[0] + green[i] * direction[1] + blue[i] * direction[2];
+
+    int minimum = 0, maximum = 0;
+    for (i = 1; i < 16; i++)
+    {
+        minimum = projections[i] < projections[minimum] ? i : minimum;
+        maximum = projections[i] > projections[maximum] ? i : maximum;
+    }
+
+    uint16_t colour0 = ctr_transcode_rgb565(red[maximum], green[maximum], blue[maximum]);
+    uint16_t colour1 = ctr_transcode_rgb565(red[minimum], green[minimum], blue[minimum]);
+    uint32_t indices = 0;
+    if (colour0 != colour1)
+    {
+        // four colour mode requires the first endpoint to be the greater
+        if (colour0 < colour1)
+        {
+            uint16_t temp = colour0;
+            colour0 = colour1;
+            colour1 = temp;
+        }
+
+        // project every pixel onto the line between the quantized endpoints
+        int start[3] =
+        {
+            ctr_transcode_rgb565_channel(colour0, 11, 5),
+            ctr_transcode_rgb565_channel(colour0, 5, 6),
+            ctr_transcode_rgb565_channel(colour0, 0, 5),
+        };
+
+        int axis[3] =
+        {
+            ctr_transcode_rgb565_channel(colour1, 11, 5) - start[0],
+            ctr_transcode_rgb565_channel(colour1, 5, 6) - start[1],
+            ctr_transcode_rgb565_channel(colour1, 0, 5) - start[2],
+        };
+
+        // the endpoints differ, so the length is never zero
+        // the vector paths count the step thresholds that each pixel reaches rather than dividing,
+        // which gives the same clamped step as the division
+        int length = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+        int steps[16];
+        i = 0;
+#if defined(__SSE2__)
+        // four pixels at a time, with each pixel's channel differences as 16-bit pairs for multiplying and adding
+        const __m128i low_mask = _mm_set1_epi32(0xffff);
+        const __m128i axis_red_green = _mm_set1_epi32((int)((axis[0] & 0xffff) | ((uint32_t)axis[1] << 16)));
+        const __m128i axis_blue = _mm_set1_epi32(axis[2] & 0xffff);
+        const __m128i start_red = _mm_set1_epi32(start[0]);
+        const __m128i start_green = _mm_set1_epi32(start[1]);
+        const __m128i start_blue = _mm_set1_epi32(start[2]);
+        const __m128i half_length = _mm_set1_epi32(length / 2);
+        const __m128i thresholds[3] =
+        {
+            _mm_set1_epi32(length - 1),
+            _mm_set1_epi32(length * 2 - 1),
+            _mm_set1_epi32(length * 3 - 1),
+        };
+
+        for (; i < 16; i += 4)
+        {
+            __m128i r = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)&red[i]), start_red);
+            __m128i g = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)&green[i]), start_green);
+            __m128i b = _mm_sub_epi32(_mm_loadu_si128((const __m128i *)&blue[i]), start_blue);
+            __m128i red_green = _mm_or_si128(_mm_and_si128(r, low_mask), _mm_slli_epi32(g, 16));
+            __m128i dot = _mm_add_epi32(_mm_madd_epi16(red_green, axis_red_green),
+                                        _mm_madd_epi16(_mm_and_si128(b, low_mask), axis_blue));
+
+            // each reached threshold is all bits set, so subtracting them counts them
+            __m128i scaled = _mm_add_epi32(_mm_add_epi32(dot, _mm_add_epi32(dot, dot)), half_length);
+            __m128i step = _mm_setzero_si128();
+            for (int t = 0; t < 3; t++)
+                step = _mm_sub_epi32(step, _mm_cmpgt_epi32(scaled, thresholds[t]));
+
+            _mm_storeu_si128((__m128i *)&steps[i], step);
+        }
+#elif defined(__ARM_NEON)
+        // four pixels at a time
+        const int32x4_t half_length = vdupq_n_s32(length / 2);
+        const int32x4_t thresholds[3] =
+        {
+            vdupq_n_s32(length),
+            vdupq_n_s32(length * 2),
+            vdupq_n_s32(length * 3),
+        };
+
+        for (; i < 16; i += 4)
+        {
+            int32x4_t dot = vmulq_n_s32(vsubq_s32(vld1q_s32(&red[i]), vdupq_n_s32(start[0])), axis[0]);
+            dot = vmlaq_n_s32(dot, vsubq_s32(vld1q_s32(&green[i]), vdupq_n_s32(start[1])), axis[1]);
+            dot = vmlaq_n_s32(dot, vsubq_s32(vld1q_s32(&blue[i]), vdupq_n_s32(start[2])), axis[2]);
+
+            // each reached threshold is all bits set, so subtracting them counts them
+            int32x4_t scaled = vaddq_s32(vmulq_n_s32(dot, 3), half_length);
+            int32x4_t step = vdupq_n_s32(0);
+            for (int t = 0; t < 3; t++)
+                step = vsubq_s32(step, vreinterpretq_s32_u32(vcgeq_s32(scaled, thresholds[t])));
+
+            vst1q_s32(&steps[i], step);
+        }
+#endif
+
+        // the remaining pixels, or all of them without vector support
+        for (; i < 16; i++)
+        {
+            int dot = (red[i] - start[0]) * axis[0] + (green[i] - start[1]) * axis[1] + (blue[i] - start[2]) * axis[2];
+            int step = (dot * 3 + length / 2) / length;
+            steps[i] = step < 0 ? 0 : (step > 3 ? 3 : step);
+        }
+
+        // map the steps from colour0 to colour1 onto the bc1 index order of colour0, colour1, then the two interpolations
+        const uint32_t step_indices[4] = { 0, 2, 3, 1 };
+        for (i = 0; i < 16; i++)
+            indices |= step_indices[steps[i]] << (i * 2);
+    }
+
+    bc1[0] = colour0 & 0xff;
+    bc1[1] = colour0 >> 8;
+    bc1[2] = colour1 & 0xff;
+    bc1[3] = colour1 >> 8;
+    bc1[4] = indices & 0xff;
+    bc1[5] = (indices >> 8) & 0xff;
+    bc1[6] = (indices >> 16) & 0xff;
+    bc1[7] = indices >> 24;
+}
+
+void ctr_transcode_alpha_to_bc4(const uint8_t *alpha, uint8_t *bc4)
+{
+    int maximum = alpha[0], minimum = alpha[0];
+    for (int i = 1; i < 16; i++)
+    {
+        maximum = alpha[i] > maximum ? alpha[i] : maximum;
+        minimum = alpha[i] < minimum ? alpha[i] : minimum;
+    }
+
+    // eight level mode, from the maximum at step 0 to the minimum at step 7
+    uint64_t indices = 0;
+    int range = maximum - minimum;
+    if (range > 0)
+    {
+        const uint64_t step_indices[8] = { 0, 2, 3, 4, 5, 6, 7, 1 };
+        for (int i = 0; i < 16; i++)
+        {
+            int step = ((maximum - alpha[i]) * 7 + range / 2) / range;
+            indices |= step_indices[step] << (i * 3);
+        }
+    }
+
+    bc4[0] = maximum;
+    bc4[1] = minimum;
+    for (int i = 0; i < 6; i++)
+        bc4[2 + i] = (indices >> (i * 8)) & 0xff;
+}
+
+uint8_t *ctr_transcode_read_bc(const struct ctr_texture_t *texture, FILE *file, size_t *size)
+{
+    assert(texture->data_format == CTR_TEXTURE_FORMAT_ETC1 || texture->data_format == CTR_TEXTURE_FORMAT_ETC1_A4);
+
+    int has_alpha = texture->data_format == CTR_TEXTURE_FORMAT_ETC1_A4;
+    uint8_t *alpha = NULL;
+    uint8_t *blocks = ctr_etc1_read(texture, file, CTR_ETC1_ALPHA_FORMAT_A8, &alpha);
+
+    unsigned int w = texture->width;
+    unsigned int num_blocks = texture->width * texture->height / 16;
+    size_t block_size = has_alpha ? 16 : 8;
+    uint8_t *transcoded = allocator_malloc(num_blocks * block_size);
+    for (unsigned int i = 0; i < num_blocks; i++)
+    {
+        uint8_t *output = &transcoded[i * block_size];
+        if (has_alpha)
+        {
+            // gather the block's alpha from the plane
+            unsigned int x = i % (w / 4) * 4;
+            unsigned int y = i / (w / 4) * 4;
+            uint8_t block_alpha[16];
+            for (unsigned int row = 0; row < 4; row++)
+                for (unsigned int column = 0; column < 4; column++)
+                    block_alpha[row * 4 + column] = alpha[(y + row) * w + x + column];
+
+            ctr_transcode_alpha_to_bc4(block_alpha, output);
+            output += 8;
+        }
+
+        ctr_transcode_etc1_to_bc1(&blocks[i * 8], output);
+    }
+
+    allocator_free(blocks);
+    allocator_free(alpha);
+    *size = num_blocks * block_size;
+    return transcoded;
+}
@@ -0,0 +1,45 @@
+//
+//  matrix.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "matrix.h"
+
+// MARK: - Functions
+
+struct matrix2d_t matrix2d_identity(void)
+{
+    struct matrix2d_t identity = { 1, 0, 0, 1, 0, 0 };
+    return identity;
+}
+
+struct matrix2d_t matrix2d_multiply(struct matrix2d_t a, struct matrix2d_t b)
+{
+    struct matrix2d_t product;
+    product.a = (a.a * b.a) + (a.c * b.b);
+    product.b = (a.b * b.a) + (a.d * b.b);
+    product.c = (a.a * b.c) + (a.c * b.d);
+    product.d = (a.b * b.c) + (a.d * b.d);
+    product.tx = (a.a * b.tx) + (a.c * b.ty) + a.tx;
+    product.ty = (a.b * b.tx) + (a.d * b.ty) + a.ty;
+    return product;
+}
+
+int matrix2d_invert(struct matrix2d_t matrix, struct matrix2d_t *inverse)
+{
+    float determinant = (matrix.a * matrix.d) - (matrix.b * matrix.c);
+    if (determinant == 0)
+        return 0;
+
+    float inverse_determinant = 1 / determinant;
+    inverse->a = matrix.d * inverse_determinant;
+    inverse->b = -matrix.b * inverse_determinant;
+    inverse->c = -matrix.c * inverse_determinant;
+    inverse->d = matrix.a * inverse_determinant;
+    inverse->tx = ((matrix.c * matrix.ty) - (matrix.d * matrix.tx)) * inverse_determinant;
+    inverse->ty = ((matrix.b * matrix.tx) - (matrix.a * matrix.ty)) * inverse_determinant;
+    return 1;
+}
@@ -12,7 +12,9 @@
 #include <string.h>
 #include <assert.h>
 
+#include "allocator.h"
 #include "ctpk.h"
+#include "utils.h"
 
 // MARK: - Constants
 
@@ -22,23 +24,26 @@ const int ctpk_name_allocated_size = 32;
 /// The size of the allocated space for each SCR name within an SPR, in bytes.
 const int scr_name_allocated_size = 71;
 
+/// The size of the header of an SPR, in bytes.
+const size_t spr_header_size = 32;
+
+/// The size of each SCR within an SPR, in bytes.
+const size_t scr_size = 96;
+
 // MARK: - Functions
 
-/// Read the string at the current offset of the given file handle, of the given allocated size.
+/// Decode the given string of the given allocated size.
 ///
 /// Strings within SPRs are stored in a semi-odd way where they allocate a fixed
 /// amount of space, then all whitespace is replaced by terminator characters.
-/// @param file The file handle to read the string from.
+/// @param characters The characters of the string, of the given allocated size.
 /// @param allocated_size The size of the allocated space for the string, in bytes.
-/// @returns The string at the current offset of the given file handle. Allocated.
-char *spr_string_read(FILE *file, int allocated_size)
+/// @returns The decoded string. Allocated.
+char *spr_string_decode(const uint8_t *characters, int allocated_size)
 {
-    char characters[allocated_size];
-    fread(characters, allocated_size, 1, file);
-
     // allocate the maximum size first,
     // then find the real size and reallocate it
-    char *name = malloc(allocated_size + 1);
+    char *name = allocator_malloc(allocated_size + 1);
     int name_index = 0;
     int name_length = 0;
     for (int i = 0; i < allocated_size; i++)
@@ -52,45 +57,146 @@ char *spr_string_read(FILE *file, int allocated_size)
     }
 
     // +1 for the terminator character
-    name = realloc(name, name_length + 1);
+    name = allocator_realloc(name, name_length + 1);
     name[name_length] = '\0';
     return name;
 }
 
-void spr_open(const char *path, struct spr_t *spr)
+/// Compare the two given strings, for use with `qsort` and `bsearch` over arrays of strings.
+/// @param a A pointer to the first string to compare.
+/// @param b A pointer to the second string to compare.
+/// @returns The order of the first string relative to the second.
+int spr_string_compare(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+/// Open the SPR file at the given path into the given SPR, keeping only the given SCRs and their textures.
+/// @param path The path of the SPR file to open.
+/// @param num_scr_names The total number of SCR names within the given array.
+/// @param scr_names The names of the SCRs to keep, sorted with `spr_string_compare`.
+/// If this is `NULL`, then every SCR and texture is kept.
+/// @param spr The SPR to open the file into.
+void spr_read(const char *path, unsigned int num_scr_names, char *const *scr_names, struct spr_t *spr)
 {
     // open the file for binary reading
     FILE *file = fopen(path, "rb");
 
+    // read the header
+    uint8_t header[spr_header_size];
+    utils_read_block(file, 0, spr_header_size, header);
+
     // signature
-    assert(fgetc(file) == 0x0);
-    assert(fgetc(file) == 0x0);
-    assert(fgetc(file) == 0x0);
-    assert(fgetc(file) == 0x0);
+    assert(utils_is_zero(header, 4));
 
-    // read the ctpk count, pointer, and names pointer
+    // ctpk count, pointer, and names pointer
     // this is actually the only count and pointer that is in the opposite order
-    uint32_t num_ctpks, ctpks_pointer, ctpk_names_pointer;
-    fread(&ctpks_pointer, sizeof(ctpks_pointer), 1, file);
-    fread(&num_ctpks, sizeof(num_ctpks), 1, file);
-    fread(&ctpk_names_pointer, sizeof(ctpk_names_pointer), 1, file);
+    uint32_t ctpks_pointer = utils_load_u32(header + 4);
+    uint32_t num_ctpks = utils_load_u32(header + 8);
+    uint32_t ctpk_names_pointer = utils_load_u32(header + 12);
 
     // padding
-    for (int i = 0; i < 8; i++)
-        assert(fgetc(file) == 0x0);
+    assert(utils_is_zero(header + 16, 8));
+
+    // scr count and pointer
+    uint32_t num_scrs = utils_load_u32(header + 24);
+    uint32_t scrs_pointer = utils_load_u32(header + 28);
+
+    // read all the scrs at once
+    uint8_t *scrs = allocator_malloc(num_scrs * scr_size);
+    utils_read_block(file, scrs_pointer, num_scrs * scr_size, scrs);
+
+    // decode the scrs, skipping those which are not needed
+    // the scrs are read first so that only the ctpks they use need to be read
+    spr->num_scrs = 0;
+    spr->scrs = allocator_malloc(num_scrs * sizeof(struct scr_t));
+    for (int i = 0; i < num_scrs; i++)
+    {
+        const uint8_t *scr_data = scrs + (i * scr_size);
+
+        // texture index
+        uint8_t texture_index = scr_data[0];
+        assert(texture_index < num_ctpks);
+
+        // name
+        char *name = spr_string_decode(scr_data + 1, scr_name_allocated_size);
+        if (scr_names != NULL && bsearch(&name, scr_names, num_scr_names, sizeof(char *), spr_string_compare) == NULL)
+        {
+            allocator_free(name);
+            continue;
+        }
+
+        // uv bounds coordinates
+        const uint8_t *uvs = scr_data + 1 + scr_name_allocated_size;
+        float start_u = utils_load_f32(uvs);
+        float start_v = utils_load_f32(uvs + 4);
+        float end_u = utils_load_f32(uvs + 8);
+        float end_v = utils_load_f32(uvs + 12);
+        assert(end_u > start_u);
+        assert(end_v > start_v);
+
+        // pixel space uv coordinates and size
+        uint16_t x = utils_load_u16(uvs + 16);
+        uint16_t y = utils_load_u16(uvs + 18);
+        uint16_t width = utils_load_u16(uvs + 20);
+        uint16_t height = utils_load_u16(uvs + 22);
 
-    // read the scr count and pointer
-    uint32_t num_scrs, scrs_pointer;
-    fread(&num_scrs, sizeof(num_scrs), 1, file);
-    fread(&scrs_pointer, sizeof(scrs_pointer), 1, file);
+        // insert the scr
+        struct scr_t scr;
+        scr.name = name;
+        scr.texture_index = texture_index;
+        scr.start_u = start_u;
+        scr.start_v = start_v;
+        scr.end_u = end_u;
+        scr.end_v = end_v;
+        scr.x = x;
+        scr.y = y;
+        scr.width = width;
+        scr.height = height;
+        spr->scrs[spr->num_scrs++] = scr;
+    }
+
+    allocator_free(scrs);
+
+    // shrink the scrs down to only those which were kept
+    if (spr->num_scrs == 0)
+    {
+        allocator_free(spr->scrs);
+        spr->scrs = NULL;
+    }
+    else if (spr->num_scrs < num_scrs)
+    {
+        spr->scrs = allocator_realloc(spr->scrs, spr->num_scrs * sizeof(struct scr_t));
+    }
+
+    // find the new index of each ctpk used by the kept scrs
+    // ctpks which are not used are left as UINT32_MAX and skipped
+    // this is sized from the file, so it is kept off the stack
+    uint32_t *texture_indices = (num_ctpks > 0) ? allocator_malloc(num_ctpks * sizeof(uint32_t)) : NULL;
+    for (int i = 0; i < num_ctpks; i++)
+        texture_indices[i] = (scr_names == NULL) ? 0 : UINT32_MAX;
+    for (int i = 0; i < spr->num_scrs; i++)
+        texture_indices[spr->scrs[i].texture_index] = 0;
+
+    uint32_t num_textures = 0;
+    for (int i = 0; i < num_ctpks; i++)
+        if (texture_indices[i] != UINT32_MAX)
+            texture_indices[i] = num_textures++;
+
+    for (int i = 0; i < spr->num_scrs; i++)
+        spr->scrs[i].texture_index = texture_indices[spr->scrs[i].texture_index];
 
     // read the textures
     // read the ctpks and then only keep their textures, as thats all thats needed
     // the pointer for each ctpk needs to be advanced by the last
     // as ctpks can be of any length
-    spr->num_textures = num_ctpks;
-    spr->textures = malloc(num_ctpks * sizeof(struct ctr_texture_t));
-    spr->texture_names = malloc(num_ctpks * sizeof(char *));
+    spr->num_textures = num_textures;
+    spr->textures = allocator_malloc(num_textures * sizeof(struct ctr_texture_t));
+    spr->texture_names = allocator_malloc(num_textures * sizeof(char *));
+
+    // read all the ctpk names at once
+    uint8_t *ctpk_names = allocator_malloc(num_ctpks * ctpk_name_allocated_size);
+    utils_read_block(file, ctpk_names_pointer, num_ctpks * ctpk_name_allocated_size, ctpk_names);
 
     uint32_t ctpk_pointer = ctpks_pointer;
     for (int i = 0; i < num_ctpks; i++)
@@ -103,88 +209,64 @@ void spr_open(const char *path, struct spr_t *spr)
         fread(&next_pointer, sizeof(next_pointer), 1, file);
         next_pointer += (uint32_t)ftell(file);
 
+        // advance the ctpk pointer
+        ctpk_pointer = next_pointer;
+
+        // skip ctpks that no kept scr uses, without parsing them
+        uint32_t texture_index = texture_indices[i];
+        if (texture_index == UINT32_MAX)
+            continue;
+
         // read the ctpk
         struct ctpk_t ctpk;
         ctpk_open(file, &ctpk);
         assert(ctpk.num_textures == 1);
 
-        // read the name
-        fseek(file, ctpk_names_pointer + (i * ctpk_name_allocated_size), SEEK_SET);
-
-        char *name = spr_string_read(file, ctpk_name_allocated_size);
-
-        // advance the ctpk pointer
-        ctpk_pointer = next_pointer;
+        // decode the name
+        char *name = spr_string_decode(ctpk_names + (i * ctpk_name_allocated_size), ctpk_name_allocated_size);
 
         // insert the texture
-        spr->textures[i] = ctpk.textures[0];
-        spr->texture_names[i] = name;
+        spr->textures[texture_index] = ctpk.textures[0];
+        spr->texture_names[texture_index] = name;
 
         // close the ctpk as its only needed to read the textures
         ctpk_close(&ctpk);
     }
 
-    // read the scrs
-    spr->num_scrs = num_scrs;
-    spr->scrs = malloc(num_scrs * sizeof(struct scr_t));
-    for (int i = 0; i < num_scrs; i++)
-    {
-        // array
-        fseek(file, scrs_pointer + (i * 96), SEEK_SET);
-
-        // read the texture index
-        uint8_t texture_index;
-        fread(&texture_index, sizeof(texture_index), 1, file);
-
-        // read the name
-        char *name = spr_string_read(file, scr_name_allocated_size);
-
-        // read the uv bounds coordinates
-        float start_u, start_v, end_u, end_v;
-        fread(&start_u, sizeof(start_u), 1, file);
-        fread(&start_v, sizeof(start_v), 1, file);
-        fread(&end_u, sizeof(end_u), 1, file);
-        fread(&end_v, sizeof(end_v), 1, file);
-        assert(end_u > start_u);
-        assert(end_v > start_v);
-
-        // read the pixel space uv coordinates and size
-        uint16_t x, y, width, height;
-        fread(&x, sizeof(x), 1, file);
-        fread(&y, sizeof(y), 1, file);
-        fread(&width, sizeof(width), 1, file);
-        fread(&height, sizeof(height), 1, file);
-
-        // insert the scr
-        struct scr_t scr;
-        scr.name = name;
-        scr.texture_index = texture_index;
-        scr.start_u = start_u;
-        scr.start_v = start_v;
-        scr.end_u = end_u;
-        scr.end_v = end_v;
-        scr.x = x;
-        scr.y = y;
-        scr.width = width;
-        scr.height = height;
-        spr->scrs[i] = scr;
-    }
+    allocator_free(ctpk_names);
+    allocator_free(texture_indices);
 
     // set the file handle
     spr->file = file;
 }
 
+void spr_open(const char *path, struct spr_t *spr)
+{
+    spr_read(path, 0, NULL, spr);
+}
+
+void spr_open_referenced(const char *path, unsigned int num_scr_names, char *const *scr_names, struct spr_t *spr)
+{
+    // sort a copy of the names so each scr can be checked with a binary search
+    char **sorted_names = allocator_malloc(num_scr_names * sizeof(char *));
+    memcpy(sorted_names, scr_names, num_scr_names * sizeof(char *));
+    qsort(sorted_names, num_scr_names, sizeof(char *), spr_string_compare);
+
+    spr_read(path, num_scr_names, sorted_names, spr);
+    allocator_free(sorted_names);
+}
+
 void spr_close(struct spr_t *spr)
 {
     for (int i = 0; i < spr->num_textures; i++)
-        free(spr->texture_names[i]);
+        allocator_free(spr->texture_names[i]);
 
     for (int i = 0; i < spr->num_scrs; i++)
-        free(spr->scrs[i].name);
+        allocator_free(spr->scrs[i].name);
 
-    free(spr->scrs);
-    free(spr->texture_names);
-    free(spr->textures);
+    allocator_free(spr->scrs);
+    allocator_free(spr->texture_names);
+    allocator_free(spr->textures);
     fclose(spr->file);
 }
 
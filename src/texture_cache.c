@@ -0,0 +1,284 @@
+//
+//  texture_cache.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "texture_cache.h"
+
+#include <stdlib.h>
+
+#include "allocator.h"
+
+// MARK: - Constants
+
+/// The number of shards that each texture cache spreads it's entries across.
+const unsigned int texture_cache_num_shards = 16;
+
+/// The number of hash buckets within each shard of a texture cache.
+const unsigned int texture_cache_num_buckets = 64;
+
+// MARK: - Functions
+
+/// Get the hash of the given texture cache key.
+/// @param key The key to get the hash of.
+/// @returns The hash of the given key.
+uint64_t texture_cache_key_hash(const struct texture_cache_key_t *key)
+{
+    // mix each field in turn, then finalize so that the low bits depend on every field
+    uint64_t hash = (uint64_t)(uintptr_t)key->source;
+    hash = (hash * 0x9e3779b97f4a7c15) ^ (uint64_t)key->data_pointer;
+    hash = (hash * 0x9e3779b97f4a7c15) ^ (uint64_t)key->data_format;
+    hash = (hash * 0x9e3779b97f4a7c15) ^ (uint64_t)key->output;
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccd;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/// Get whether or not the two given texture cache keys are equal.
+/// @param a The first key to compare.
+/// @param b The second key to compare.
+/// @returns Whether or not the given keys are equal.
+int texture_cache_key_equal(const struct texture_cache_key_t *a, const struct texture_cache_key_t *b)
+{
+    return a->source == b->source &&
+           a->data_pointer == b->data_pointer &&
+           a->data_format == b->data_format &&
+           a->output == b->output;
+}
+
+/// Remove the given entry from the recency list of the given shard.
+///
+/// The calling thread must hold the given shard's mutex.
+/// @param shard The shard containing the given entry.
+/// @param entry The entry to remove.
+void texture_cache_shard_unlink(struct texture_cache_shard_t *shard, struct texture_cache_entry_t *entry)
+{
+    if (entry->newer != NULL)
+        entry->newer->older = entry->older;
+    else
+        shard->newest = entry->older;
+
+    if (entry->older != NULL)
+        entry->older->newer = entry->newer;
+    else
+        shard->oldest = entry->newer;
+
+    entry->newer = NULL;
+    entry->older = NULL;
+}
+
+/// Insert the given entry as the most recently used of the given shard.
+///
+/// The calling thread must hold the given shard's mutex.
+/// @param shard The shard to insert the given entry into.
+/// @param entry The entry to insert, which must not already be within the recency list.
+void texture_cache_shard_link(struct texture_cache_shard_t *shard, struct texture_cache_entry_t *entry)
+{
+    entry->newer = NULL;
+    entry->older = shard->newest;
+    if (shard->newest != NULL)
+        shard->newest->newer = entry;
+    else
+        shard->oldest = entry;
+
+    shard->newest = entry;
+}
+
+/// Evict the least recently used unpinned entry of the given shard, if any.
+///
+/// The calling thread must hold the given shard's mutex.
+/// @param cache The texture cache containing the given shard.
+/// @param shard The shard to evict from.
+/// @returns Whether or not an entry was evicted.
+int texture_cache_shard_evict(struct texture_cache_t *cache, struct texture_cache_shard_t *shard)
+{
+    struct texture_cache_entry_t *entry = shard->oldest;
+    while (entry != NULL && entry->pins > 0)
+        entry = entry->newer;
+
+    if (entry == NULL)
+        return 0;
+
+    // remove the entry from its bucket
+    uint64_t hash = texture_cache_key_hash(&entry->key);
+    struct texture_cache_entry_t **link = &shard->buckets[(hash / texture_cache_num_shards) % texture_cache_num_buckets];
+    while (*link != entry)
+        link = &(*link)->bucket_next;
+
+    *link = entry->bucket_next;
+    texture_cache_shard_unlink(shard, entry);
+    atomic_fetch_sub(&cache->size, entry->size);
+    allocator_free(entry->data);
+    allocator_free(entry);
+    return 1;
+}
+
+/// Evict entries from the given texture cache until it is within it's budget,
+/// or until every remaining entry is pinned.
+///
+/// The calling thread must not hold any shard's mutex.
+/// @param cache The texture cache to evict from.
+void texture_cache_trim(struct texture_cache_t *cache)
+{
+    const struct allocator_t *previous_allocator = allocator_set_thread(cache->allocator);
+
+    // visit the shards in turn, evicting the oldest of each, until a full pass evicts nothing
+    unsigned int num_unproductive = 0;
+    while (atomic_load(&cache->size) > cache->budget && num_unproductive < texture_cache_num_shards)
+    {
+        unsigned int shard_index = atomic_fetch_add(&cache->eviction_shard, 1) % texture_cache_num_shards;
+        struct texture_cache_shard_t *shard = &cache->shards[shard_index];
+        pthread_mutex_lock(&shard->mutex);
+        int evicted = texture_cache_shard_evict(cache, shard);
+        pthread_mutex_unlock(&shard->mutex);
+
+        num_unproductive = evicted ? 0 : num_unproductive + 1;
+    }
+
+    allocator_set_thread(previous_allocator);
+}
+
+void texture_cache_create(size_t budget, struct texture_cache_t *cache)
+{
+    cache->budget = budget;
+    cache->allocator = allocator_get_thread();
+    atomic_init(&cache->size, 0);
+    atomic_init(&cache->eviction_shard, 0);
+    cache->shards = allocator_malloc(texture_cache_num_shards * sizeof(struct texture_cache_shard_t));
+    for (unsigned int i = 0; i < texture_cache_num_shards; i++)
+    {
+        struct texture_cache_shard_t *shard = &cache->shards[i];
+        pthread_mutex_init(&shard->mutex, NULL);
+        pthread_cond_init(&shard->decoded, NULL);
+        shard->buckets = allocator_calloc(texture_cache_num_buckets, sizeof(struct texture_cache_entry_t *));
+        shard->newest = NULL;
+        shard->oldest = NULL;
+    }
+}
+
+void texture_cache_destroy(struct texture_cache_t *cache)
+{
+    for (unsigned int i = 0; i < texture_cache_num_shards; i++)
+    {
+        struct texture_cache_shard_t *shard = &cache->shards[i];
+        for (unsigned int b = 0; b < texture_cache_num_buckets; b++)
+        {
+            struct texture_cache_entry_t *entry = shard->buckets[b];
+            while (entry != NULL)
+            {
+                struct texture_cache_entry_t *next = entry->bucket_next;
+                allocator_free(entry->data);
+                allocator_free(entry);
+                entry = next;
+            }
+        }
+
+        allocator_free(shard->buckets);
+        pthread_cond_destroy(&shard->decoded);
+        pthread_mutex_destroy(&shard->mutex);
+    }
+
+    allocator_free(cache->shards);
+}
+
+struct texture_cache_entry_t *texture_cache_acquire(struct texture_cache_t *cache,
+                                                   const void *source,
+                                                   FILE *file,
+                                                   const struct ctr_texture_t *texture,
+                                                   enum texture_cache_output_t output)
+{
+    struct texture_cache_key_t key = { source, texture->data_pointer, texture->data_format, output };
+    uint64_t hash = texture_cache_key_hash(&key);
+    unsigned int shard_index = hash % texture_cache_num_shards;
+    struct texture_cache_shard_t *shard = &cache->shards[shard_index];
+    struct texture_cache_entry_t **bucket = &shard->buckets[(hash / texture_cache_num_shards) % texture_cache_num_buckets];
+
+    const struct allocator_t *previous_allocator = allocator_set_thread(cache->allocator);
+    pthread_mutex_lock(&shard->mutex);
+
+    struct texture_cache_entry_t *entry = *bucket;
+    while (entry != NULL && !texture_cache_key_equal(&entry->key, &key))
+        entry = entry->bucket_next;
+
+    if (entry != NULL)
+    {
+        // pin before waiting so the entry cannot be evicted once it is ready
+        entry->pins++;
+        while (!entry->ready)
+            pthread_cond_wait(&shard->decoded, &shard->mutex);
+
+        texture_cache_shard_unlink(shard, entry);
+        texture_cache_shard_link(shard, entry);
+        pthread_mutex_unlock(&shard->mutex);
+        allocator_set_thread(previous_allocator);
+        return entry;
+    }
+
+    // insert a placeholder so concurrent acquisitions of the same texture wait for this decode
+    entry = allocator_malloc(sizeof(struct texture_cache_entry_t));
+    entry->key = key;
+    entry->data = NULL;
+    entry->size = 0;
+    entry->pins = 1;
+    entry->ready = 0;
+    entry->shard_index = shard_index;
+    entry->bucket_next = *bucket;
+    entry->newer = NULL;
+    entry->older = NULL;
+    *bucket = entry;
+    pthread_mutex_unlock(&shard->mutex);
+
+    // decode without holding the shard's lock
+    // unpacked data is decoded straight from the tiles on the heap, as this is often called from threads with small stacks,
+    // and only the read holds the file's lock so that textures from the same file are decoded in parallel
+    uint8_t *data;
+    size_t size;
+    if (output == TEXTURE_CACHE_OUTPUT_UNPACKED)
+    {
+        uint8_t *encoded = allocator_malloc(texture->data_size);
+        flockfile(file);
+        fseek(file, texture->data_pointer, SEEK_SET);
+        fread(encoded, texture->data_size, 1, file);
+        funlockfile(file);
+
+        struct ctr_texture_unpack_options_t options = { CTR_TEXTURE_UNPACK_FORMAT_RGBA8888, CTR_TEXTURE_CHANNEL_ORDER_RGBA, 0, 0 };
+        data = ctr_texture_decode_unpacked_encoded(texture, encoded, &options);
+        size = texture->unpacked_data_size;
+        allocator_free(encoded);
+    }
+    else
+    {
+        flockfile(file);
+        data = ctr_texture_decode(texture, file);
+        size = texture->decoded_data_size;
+        funlockfile(file);
+    }
+
+    // publish the data and wake any waiting acquisitions
+    pthread_mutex_lock(&shard->mutex);
+    entry->data = data;
+    entry->size = size;
+    entry->ready = 1;
+    texture_cache_shard_link(shard, entry);
+    atomic_fetch_add(&cache->size, size);
+    pthread_cond_broadcast(&shard->decoded);
+    pthread_mutex_unlock(&shard->mutex);
+    allocator_set_thread(previous_allocator);
+
+    texture_cache_trim(cache);
+    return entry;
+}
+
+void texture_cache_release(struct texture_cache_t *cache, struct texture_cache_entry_t *entry)
+{
+    struct texture_cache_shard_t *shard = &cache->shards[entry->shard_index];
+    pthread_mutex_lock(&shard->mutex);
+    entry->pins--;
+    pthread_mutex_unlock(&shard->mutex);
+
+    texture_cache_trim(cache);
+}
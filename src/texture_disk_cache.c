@@ -0,0 +1,228 @@
+//
+//  texture_disk_cache.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "texture_disk_cache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "allocator.h"
+
+// MARK: - Constants
+
+/// The signature at the beginning of every disk cache file.
+const char texture_disk_cache_magic[4] = { 'M', 'T', 'X', 'C' };
+
+/// The version of the disk cache file layout.
+///
+/// This must be incremented whenever the layout of disk cache files, or the output of unpacking, changes.
+const uint32_t texture_disk_cache_version = 2;
+
+/// The offset of the unpacked data within each disk cache file, in bytes.
+///
+/// This is a multiple of every common page size, so the data is page aligned when the file is mapped.
+const uint32_t texture_disk_cache_data_offset = 16384;
+
+// MARK: - Data Structures
+
+/// The data structure for the header at the beginning of every disk cache file.
+struct texture_disk_cache_header_t
+{
+    /// The signature of the file, always `texture_disk_cache_magic`.
+    char magic[4];
+
+    /// The version of the file's layout, always `texture_disk_cache_version` for valid files.
+    uint32_t version;
+
+    /// The hash of the texture's encoded data, see `utils_hash64(data, size)`.
+    uint64_t hash;
+
+    /// The format of the texture's encoded data.
+    uint32_t data_format;
+
+    /// The width of the texture, in pixels.
+    uint32_t width;
+
+    /// The height of the texture, in pixels.
+    uint32_t height;
+
+    /// The offset of the unpacked data within the file, in bytes.
+    uint32_t data_offset;
+
+    /// The size of the unpacked data, in bytes.
+    uint64_t data_size;
+};
+
+// MARK: - Functions
+
+void texture_disk_cache_open(const char *directory, struct texture_disk_cache_t *cache)
+{
+    // an existing directory is fine, any other failure is caught when writing
+    mkdir(directory, 0755);
+
+    cache->directory = allocator_malloc(strlen(directory) + 1);
+    strcpy(cache->directory, directory);
+}
+
+void texture_disk_cache_close(struct texture_disk_cache_t *cache)
+{
+    allocator_free(cache->directory);
+}
+
+/// Attempt to map the disk cache file at the given path, checking that it matches the given header.
+/// @param path The path of the file to map.
+/// @param header The header that the file must have.
+/// @param entry The entry to write the mapping to.
+/// @returns Whether or not the file exists, is valid, and matches the given header.
+int texture_disk_cache_map(const char *path,
+                           const struct texture_disk_cache_header_t *header,
+                           struct texture_disk_cache_entry_t *entry)
+{
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0)
+        return 0;
+
+    struct stat status;
+    size_t expected_size = header->data_offset + header->data_size;
+    if (fstat(descriptor, &status) != 0 || (size_t)status.st_size != expected_size)
+    {
+        close(descriptor);
+        return 0;
+    }
+
+    void *mapping = mmap(NULL, expected_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (mapping == MAP_FAILED)
+        return 0;
+
+    if (memcmp(mapping, header, sizeof(struct texture_disk_cache_header_t)) != 0)
+    {
+        munmap(mapping, expected_size);
+        return 0;
+    }
+
+    entry->data = (const uint8_t *)mapping + header->data_offset;
+    entry->size = header->data_size;
+    entry->mapping = mapping;
+    entry->mapping_size = expected_size;
+    return 1;
+}
+
+/// Write a disk cache file to the given path with the given header and data.
+///
+/// The file is written to a uniquely named temporary file within the same directory and then renamed into place,
+/// so readers never see a partially written file and concurrent writers of the same texture do not conflict.
+/// @param directory The directory containing the given path.
+/// @param path The path of the file to write.
+/// @param header The header of the file.
+/// @param data The unpacked data of the file, of the header's data size.
+/// @returns Whether or not the file was written.
+int texture_disk_cache_write(const char *directory,
+                             const char *path,
+                             const struct texture_disk_cache_header_t *header,
+                             const uint8_t *data)
+{
+    char temporary_path[strlen(directory) + 16];
+    sprintf(temporary_path, "%s/.tmp-XXXXXX", directory);
+    int descriptor = mkstemp(temporary_path);
+    if (descriptor < 0)
+        return 0;
+
+    FILE *file = fdopen(descriptor, "wb");
+    if (file == NULL)
+    {
+        close(descriptor);
+        unlink(temporary_path);
+        return 0;
+    }
+
+    // the header is zero padded up to the data offset
+    uint8_t padding[texture_disk_cache_data_offset];
+    memset(padding, 0, sizeof(padding));
+    memcpy(padding, header, sizeof(struct texture_disk_cache_header_t));
+
+    int written = fwrite(padding, sizeof(padding), 1, file) == 1 &&
+                  fwrite(data, header->data_size, 1, file) == 1;
+
+    written = (fclose(file) == 0) && written;
+    if (!written || rename(temporary_path, path) != 0)
+    {
+        unlink(temporary_path);
+        return 0;
+    }
+
+    return 1;
+}
+
+void texture_disk_cache_get(struct texture_disk_cache_t *cache,
+                            struct ctr_texture_t *texture,
+                            FILE *file,
+                            struct texture_disk_cache_entry_t *entry)
+{
+    uint64_t hash = ctr_texture_hash(texture, file);
+
+    struct texture_disk_cache_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, texture_disk_cache_magic, sizeof(header.magic));
+    header.version = texture_disk_cache_version;
+    header.hash = hash;
+    header.data_format = texture->data_format;
+    header.width = texture->width;
+    header.height = texture->height;
+    header.data_offset = texture_disk_cache_data_offset;
+    header.data_size = texture->unpacked_data_size;
+
+    char path[strlen(cache->directory) + 64];
+    sprintf(path,
+            "%s/%016llx-%x-%ux%u.rgba",
+            cache->directory,
+            (unsigned long long)hash,
+            texture->data_format,
+            texture->width,
+            texture->height);
+
+    if (texture_disk_cache_map(path, &header, entry))
+        return;
+
+    // decode and write the texture, then map the written file
+    // only the read holds the file's lock, as the file may be shared with other threads
+    uint8_t *encoded = allocator_malloc(texture->data_size);
+    flockfile(file);
+    fseek(file, texture->data_pointer, SEEK_SET);
+    fread(encoded, texture->data_size, 1, file);
+    funlockfile(file);
+
+    struct ctr_texture_unpack_options_t options = { CTR_TEXTURE_UNPACK_FORMAT_RGBA8888, CTR_TEXTURE_CHANNEL_ORDER_RGBA, 0, 0 };
+    uint8_t *unpacked = ctr_texture_decode_unpacked_encoded(texture, encoded, &options);
+    allocator_free(encoded);
+
+    if (texture_disk_cache_write(cache->directory, path, &header, unpacked) &&
+        texture_disk_cache_map(path, &header, entry))
+    {
+        allocator_free(unpacked);
+        return;
+    }
+
+    // the cache could not be written, so use the unpacked data directly
+    entry->data = unpacked;
+    entry->size = texture->unpacked_data_size;
+    entry->mapping = NULL;
+    entry->mapping_size = 0;
+}
+
+void texture_disk_cache_entry_release(struct texture_disk_cache_entry_t *entry)
+{
+    if (entry->mapping != NULL)
+        munmap(entry->mapping, entry->mapping_size);
+    else
+        allocator_free((uint8_t *)entry->data);
+}
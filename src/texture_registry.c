@@ -0,0 +1,141 @@
+//
+//  texture_registry.c
+//  libmirai
+//
+//  Created by Marika on 2026-10-18.
+//  Copyright © 2026 Marika. All rights reserved.
+//
+
+#include "texture_registry.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+
+#include "allocator.h"
+
+// MARK: - Constants
+
+/// The number of hash buckets within each texture registry.
+const unsigned int texture_registry_num_buckets = 256;
+
+// MARK: - Functions
+
+void texture_registry_create(struct texture_registry_t *registry)
+{
+    pthread_mutex_init(&registry->mutex, NULL);
+    pthread_cond_init(&registry->decoded, NULL);
+    registry->buckets = allocator_calloc(texture_registry_num_buckets, sizeof(struct texture_registry_entry_t *));
+    registry->num_entries = 0;
+    registry->size = 0;
+    registry->allocator = allocator_get_thread();
+}
+
+void texture_registry_destroy(struct texture_registry_t *registry)
+{
+    assert(registry->num_entries == 0);
+    allocator_free(registry->buckets);
+    pthread_cond_destroy(&registry->decoded);
+    pthread_mutex_destroy(&registry->mutex);
+}
+
+struct texture_registry_entry_t *texture_registry_acquire(struct texture_registry_t *registry,
+                                                         struct ctr_texture_t *texture,
+                                                         FILE *file)
+{
+    const struct allocator_t *previous_allocator = allocator_set_thread(registry->allocator);
+    uint64_t hash = ctr_texture_hash(texture, file);
+
+    // read the encoded data, both to confirm a match and to decode from
+    uint8_t *encoded = allocator_malloc(texture->data_size);
+    flockfile(file);
+    fseek(file, texture->data_pointer, SEEK_SET);
+    fread(encoded, texture->data_size, 1, file);
+    funlockfile(file);
+
+    // the hash is already well mixed, so the low bits can be used directly
+    struct texture_registry_entry_t **bucket = &registry->buckets[hash % texture_registry_num_buckets];
+
+    pthread_mutex_lock(&registry->mutex);
+
+    // compare the encoded data of matching entries, so that a hash collision never shares another texture's pixels
+    struct texture_registry_entry_t *entry = *bucket;
+    while (entry != NULL && (entry->hash != hash ||
+                             entry->data_format != texture->data_format ||
+                             entry->width != texture->width ||
+                             entry->height != texture->height ||
+                             entry->encoded_size != texture->data_size ||
+                             memcmp(entry->encoded, encoded, texture->data_size) != 0))
+        entry = entry->bucket_next;
+
+    if (entry != NULL)
+    {
+        // reference before waiting so the entry cannot be freed once it is ready
+        entry->references++;
+        while (!entry->ready)
+            pthread_cond_wait(&registry->decoded, &registry->mutex);
+
+        pthread_mutex_unlock(&registry->mutex);
+        allocator_free(encoded);
+        allocator_set_thread(previous_allocator);
+        return entry;
+    }
+
+    // insert a placeholder so concurrent acquisitions of identical textures wait for this decode
+    entry = allocator_malloc(sizeof(struct texture_registry_entry_t));
+    entry->hash = hash;
+    entry->data_format = texture->data_format;
+    entry->width = texture->width;
+    entry->height = texture->height;
+    entry->encoded = encoded;
+    entry->encoded_size = texture->data_size;
+    entry->data = NULL;
+    entry->size = 0;
+    entry->references = 1;
+    entry->ready = 0;
+    entry->bucket_next = *bucket;
+    *bucket = entry;
+    registry->num_entries++;
+    pthread_mutex_unlock(&registry->mutex);
+
+    // decode without holding the registry's lock, keeping the texture off the stack of the calling thread
+    struct ctr_texture_unpack_options_t options = { CTR_TEXTURE_UNPACK_FORMAT_RGBA8888, CTR_TEXTURE_CHANNEL_ORDER_RGBA, 0, 0 };
+    uint8_t *unpacked = ctr_texture_decode_unpacked_encoded(texture, encoded, &options);
+
+    // publish the data and wake any waiting acquisitions
+    pthread_mutex_lock(&registry->mutex);
+    entry->data = unpacked;
+    entry->size = texture->unpacked_data_size;
+    entry->ready = 1;
+    registry->size += entry->size;
+    pthread_cond_broadcast(&registry->decoded);
+    pthread_mutex_unlock(&registry->mutex);
+    allocator_set_thread(previous_allocator);
+    return entry;
+}
+
+void texture_registry_release(struct texture_registry_t *registry, struct texture_registry_entry_t *entry)
+{
+    pthread_mutex_lock(&registry->mutex);
+    if (--entry->references > 0)
+    {
+        pthread_mutex_unlock(&registry->mutex);
+        return;
+    }
+
+    // remove the entry from its bucket
+    struct texture_registry_entry_t **link = &registry->buckets[entry->hash % texture_registry_num_buckets];
+    while (*link != entry)
+        link = &(*link)->bucket_next;
+
+    *link = entry->bucket_next;
+    registry->num_entries--;
+    registry->size -= entry->size;
+    pthread_mutex_unlock(&registry->mutex);
+
+    const struct allocator_t *previous_allocator = allocator_set_thread(registry->allocator);
+    allocator_free(entry->data);
+    allocator_free(entry->encoded);
+    allocator_free(entry);
+    allocator_set_thread(previous_allocator);
+}
@@ -10,6 +10,9 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <assert.h>
+
+#include "allocator.h"
 
 // MARK: - Functions
 
@@ -41,7 +44,173 @@ char *utils_read_string(FILE *file)
             break;
     }
 
-    char *string = malloc(string_length);
+    char *string = allocator_malloc(string_length);
     memcpy(string, string_fixed, string_length);
     return string;
 }
+
+void utils_read_block(FILE *file, long pointer, size_t size, void *buffer)
+{
+    fseek(file, pointer, SEEK_SET);
+    size_t read_size = fread(buffer, 1, size, file);
+    assert(read_size == size);
+
+    // zero whatever a short read left, so truncated files decode the same with or without assertions
+    if (read_size < size)
+        memset((uint8_t *)buffer + read_size, 0, size - read_size);
+}
+
+uint16_t utils_load_u16(const uint8_t *data)
+{
+    return (uint16_t)(data[0] | (data[1] << 8));
+}
+
+uint32_t utils_load_u32(const uint8_t *data)
+{
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+float utils_load_f32(const uint8_t *data)
+{
+    uint32_t bits = utils_load_u32(data);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+int utils_is_zero(const uint8_t *data, size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+        if (data[i] != 0x0)
+            return 0;
+
+    return 1;
+}
+
+/// The primes used by XXH64.
+const uint64_t utils_hash64_primes[5] =
+{
+    0x9e3779b185ebca87,
+    0xc2b2ae3d27d4eb4f,
+    0x165667b19e3779f9,
+    0x85ebca77c2b2ae63,
+    0x27d4eb2f165667c5,
+};
+
+/// Rotate the given value left by the given number of bits.
+/// @param value The value to rotate.
+/// @param bits The number of bits to rotate by, from `1` to `63`.
+/// @returns The given value rotated left by the given number of bits.
+uint64_t utils_rotate_left(uint64_t value, int bits)
+{
+    return (value << bits) | (value >> (64 - bits));
+}
+
+/// Mix the given input into the given XXH64 accumulator.
+/// @param accumulator The accumulator to mix into.
+/// @param input The input to mix.
+/// @returns The mixed accumulator.
+uint64_t utils_hash64_round(uint64_t accumulator, uint64_t input)
+{
+    accumulator += input * utils_hash64_primes[1];
+    accumulator = utils_rotate_left(accumulator, 31);
+    return accumulator * utils_hash64_primes[0];
+}
+
+/// Merge the given XXH64 accumulator into the given hash.
+/// @param hash The hash to merge into.
+/// @param accumulator The accumulator to merge.
+/// @returns The merged hash.
+uint64_t utils_hash64_merge(uint64_t hash, uint64_t accumulator)
+{
+    hash ^= utils_hash64_round(0, accumulator);
+    return (hash * utils_hash64_primes[0]) + utils_hash64_primes[3];
+}
+
+uint64_t utils_hash64(const void *data, size_t size)
+{
+    const uint8_t *bytes = data;
+    const uint8_t *end = bytes + size;
+    uint64_t hash;
+
+    // hash the bulk of the data in 32 byte stripes over four accumulators
+    if (size >= 32)
+    {
+        uint64_t accumulators[4] =
+        {
+            utils_hash64_primes[0] + utils_hash64_primes[1],
+            utils_hash64_primes[1],
+            0,
+            -utils_hash64_primes[0],
+        };
+
+        for (; bytes + 32 <= end; bytes += 32)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                uint64_t lane;
+                memcpy(&lane, bytes + (i * 8), sizeof(lane));
+                accumulators[i] = utils_hash64_round(accumulators[i], lane);
+            }
+        }
+
+        hash = utils_rotate_left(accumulators[0], 1) +
+               utils_rotate_left(accumulators[1], 7) +
+               utils_rotate_left(accumulators[2], 12) +
+               utils_rotate_left(accumulators[3], 18);
+
+        for (int i = 0; i < 4; i++)
+            hash = utils_hash64_merge(hash, accumulators[i]);
+    }
+    else
+        hash = utils_hash64_primes[4];
+
+    hash += size;
+
+    // hash the remaining bytes
+    for (; bytes + 8 <= end; bytes += 8)
+    {
+        uint64_t lane;
+        memcpy(&lane, bytes, sizeof(lane));
+        hash ^= utils_hash64_round(0, lane);
+        hash = (utils_rotate_left(hash, 27) * utils_hash64_primes[0]) + utils_hash64_primes[3];
+    }
+
+    if (bytes + 4 <= end)
+    {
+        uint32_t lane;
+        memcpy(&lane, bytes, sizeof(lane));
+        hash ^= (uint64_t)lane * utils_hash64_primes[0];
+        hash = (utils_rotate_left(hash, 23) * utils_hash64_primes[1]) + utils_hash64_primes[2];
+        bytes += 4;
+    }
+
+    for (; bytes < end; bytes++)
+    {
+        hash ^= *bytes * utils_hash64_primes[4];
+        hash = utils_rotate_left(hash, 11) * utils_hash64_primes[0];
+    }
+
+    // avalanche
+    hash ^= hash >> 33;
+    hash *= utils_hash64_primes[1];
+    hash ^= hash >> 29;
+    hash *= utils_hash64_primes[2];
+    hash ^= hash >> 32;
+    return hash;
+}
+
+uint32_t utils_crc32(const void *data, size_t size)
+{
+    // bitwise rather than table driven, as this is only used for short strings
+    const uint8_t *bytes = data;
+    uint32_t crc = 0xffffffff;
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; bit++)
+            crc = (crc >> 1) ^ (0xedb88320 & -(crc & 1));
+    }
+
+    return ~crc;
+}